@@ -28,6 +28,10 @@ void analytics_init(analytics_t *a) {
 
     a->fpsTimestampsCount = 0;
     a->fpsTimestampsHead = 0;
+
+    a->uploads = 0;
+    a->deferredUploads = 0;
+    a->framesDeferring = 0;
 }
 
 void analytics_startFrame(analytics_t *a) {
@@ -35,4 +39,12 @@ void analytics_startFrame(analytics_t *a) {
     a->currentTime = glfwGetTime();
     a->dt = a->currentTime - a->previousTime;
     fpsUpdate(a);
+}
+
+void analytics_recordUploads(analytics_t *a, const size_t uploads, const size_t deferred) {
+    a->uploads = uploads;
+    a->deferredUploads = deferred;
+    if (deferred > 0) {
+        a->framesDeferring++;
+    }
 }
\ No newline at end of file
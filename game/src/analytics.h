@@ -1,6 +1,8 @@
 #ifndef ANALYTICS_H
 #define ANALYTICS_H
 
+#include <stddef.h>
+
 #define FPS_QUEUE_SIZE 1024
 
 typedef struct {
@@ -16,10 +18,25 @@ typedef struct {
     double fpsTimestamps[FPS_QUEUE_SIZE];
     int fpsTimestampsHead;
     int fpsTimestampsCount;
+
+    /// The chunk meshes uploaded in the last frame
+    size_t uploads;
+    /// The chunk meshes left waiting for a later frame after the last one
+    size_t deferredUploads;
+    /// The frames that left meshes waiting, until reset by the caller
+    size_t framesDeferring;
 } analytics_t;
 
 void analytics_init(analytics_t *a);
 
 void analytics_startFrame(analytics_t *a);
 
+/**
+ * @brief Records the chunk mesh uploads of a frame
+ * @param a A pointer to the analytics
+ * @param uploads The meshes uploaded
+ * @param deferred The meshes left waiting for a later frame
+ */
+void analytics_recordUploads(analytics_t *a, size_t uploads, size_t deferred);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <logging.h>
+#include <time.h>
+#include "bench.h"
+
+double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void bench_initContext(void) {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Benchmark", NULL, NULL);
+    if (window == NULL) {
+        LOG_FATAL("Failed to create GLFW window");
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGL(glfwGetProcAddress)) {
+        LOG_FATAL("Failed to initialise glad");
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/**
+ * @brief Gets a monotonic timestamp
+ * @return The time in seconds
+ */
+double bench_now(void);
+
+/**
+ * @brief Creates a hidden window so world code that touches OpenGL can run
+ */
+void bench_initContext(void);
+
+#endif
@@ -0,0 +1,107 @@
+#include <logging.h>
+#include <stdlib.h>
+#include <uthash.h>
+#include "bench.h"
+#include "clusterindex.h"
+
+/*
+ * Compares chunk lookups through the cluster index against the uthash table it replaced.
+ * The key set and probe pattern are those of a full radius-7 world: every loaded chunk
+ * looks up itself and its 26 neighbours, which is what meshing and lighting do.
+ */
+
+#define LOAD_RADIUS 7
+#define LOG_C_T 3
+#define REPEATS 50
+
+typedef struct {
+    clusterKey_t key;
+    UT_hash_handle hh;
+} hashCluster_t;
+
+static clusterKey_t toClusterKey(const int cx, const int cy, const int cz) {
+    return (clusterKey_t){ cx >> LOG_C_T, cy >> LOG_C_T, cz >> LOG_C_T };
+}
+
+static bool inSphere(const int x, const int y, const int z) {
+    return x * x + y * y + z * z <= LOAD_RADIUS * LOAD_RADIUS;
+}
+
+int main(void) {
+    log_init(stdout);
+
+    hashCluster_t *table = NULL;
+    clusterIndex_t index;
+    clusterIndex_init(&index, 8);
+
+    // Building both tables from the clusters a radius-7 world touches
+    int nChunks = 0;
+    for (int x = -LOAD_RADIUS - 1; x <= LOAD_RADIUS + 1; x++) {
+        for (int y = -LOAD_RADIUS - 1; y <= LOAD_RADIUS + 1; y++) {
+            for (int z = -LOAD_RADIUS - 1; z <= LOAD_RADIUS + 1; z++) {
+                if (inSphere(x, y, z)) nChunks++;
+                const clusterKey_t k = toClusterKey(x, y, z);
+                if (clusterIndex_get(&index, k)) continue;
+
+                hashCluster_t *c = calloc(1, sizeof(hashCluster_t));
+                c->key = k;
+                HASH_ADD(hh, table, key, sizeof(clusterKey_t), c);
+                clusterIndex_insert(&index, k, c);
+            }
+        }
+    }
+    LOG_INFO("%d chunks in %zu clusters", nChunks, index.count);
+
+    const long long lookups = (long long)nChunks * 27 * REPEATS;
+    size_t found = 0;
+
+    double start = bench_now();
+    for (int r = 0; r < REPEATS; r++) {
+        for (int x = -LOAD_RADIUS; x <= LOAD_RADIUS; x++) {
+            for (int y = -LOAD_RADIUS; y <= LOAD_RADIUS; y++) {
+                for (int z = -LOAD_RADIUS; z <= LOAD_RADIUS; z++) {
+                    if (!inSphere(x, y, z)) continue;
+                    for (int n = 0; n < 27; n++) {
+                        const clusterKey_t k = toClusterKey(x + n / 9 - 1, y + n / 3 % 3 - 1, z + n % 3 - 1);
+                        hashCluster_t *c;
+                        HASH_FIND(hh, table, &k, sizeof(clusterKey_t), c);
+                        found += c != NULL;
+                    }
+                }
+            }
+        }
+    }
+    const double uthashTime = bench_now() - start;
+
+    start = bench_now();
+    for (int r = 0; r < REPEATS; r++) {
+        for (int x = -LOAD_RADIUS; x <= LOAD_RADIUS; x++) {
+            for (int y = -LOAD_RADIUS; y <= LOAD_RADIUS; y++) {
+                for (int z = -LOAD_RADIUS; z <= LOAD_RADIUS; z++) {
+                    if (!inSphere(x, y, z)) continue;
+                    for (int n = 0; n < 27; n++) {
+                        const clusterKey_t k = toClusterKey(x + n / 9 - 1, y + n / 3 % 3 - 1, z + n % 3 - 1);
+                        found += clusterIndex_get(&index, k) != NULL;
+                    }
+                }
+            }
+        }
+    }
+    const double indexTime = bench_now() - start;
+
+    if (found != 2 * (size_t)lookups) {
+        LOG_FATAL("Lookup mismatch: %zu found", found);
+    }
+
+    LOG_INFO("uthash:        %.1f M lookups/s", (double)lookups / uthashTime * 1e-6);
+    LOG_INFO("cluster index: %.1f M lookups/s (%.2fx)", (double)lookups / indexTime * 1e-6, uthashTime / indexTime);
+
+    hashCluster_t *c, *tmp;
+    HASH_ITER(hh, table, c, tmp) {
+        HASH_DEL(table, c);
+        free(c);
+    }
+    clusterIndex_free(&index);
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <logging.h>
+#include "bench.h"
+#include "world.h"
+
+/*
+ * Times filling and clearing a 32^3 cuboid at spawn, once as a single region edit
+ * and once as one edit per block. Each is timed until the chunk loading pass that
+ * applies it, propagates its light and remeshes the affected chunks has finished.
+ * Single edits are applied whenever the edit queue fills, as they would be in game.
+ */
+
+#define REGION_SIZE 32
+
+static const ivec3 minPoint = { -REGION_SIZE / 2, 0, -REGION_SIZE / 2 };
+static const ivec3 maxPoint = { REGION_SIZE / 2, REGION_SIZE, REGION_SIZE / 2 };
+
+static double timeRegion(world_t *w, const block_t block) {
+    const double start = bench_now();
+    world_fillRegion(w, minPoint, maxPoint, block);
+    world_doChunkLoading(w);
+    return bench_now() - start;
+}
+
+static double timeSingle(world_t *w, const block_t block) {
+    const double start = bench_now();
+    int queued = 0;
+    for (int x = minPoint[0]; x < maxPoint[0]; x++) {
+        for (int y = minPoint[1]; y < maxPoint[1]; y++) {
+            for (int z = minPoint[2]; z < maxPoint[2]; z++) {
+                const worldBlockEdit_t edit = { .x = x, .y = y, .z = z, .block = block };
+                world_editRegion(w, &edit, 1);
+                if (++queued == WORLD_EDIT_QUEUE_SIZE) {
+                    world_doChunkLoading(w);
+                    queued = 0;
+                }
+            }
+        }
+    }
+    world_doChunkLoading(w);
+    return bench_now() - start;
+}
+
+static void report(const char *name, const double elapsed) {
+    const int edits = REGION_SIZE * REGION_SIZE * REGION_SIZE;
+    LOG_INFO("%-20s %8.2f ms, %10.0f edits/s", name, elapsed * 1e3, edits / elapsed);
+}
+
+int main(void) {
+    log_init(stdout);
+    bench_initContext();
+
+    world_t world;
+    world_init(&world, 40);
+
+    unsigned int spawnLoader;
+    world_genChunkLoader(&world, &spawnLoader);
+    world_updateChunkLoader(&world, spawnLoader, GLM_VEC3_ZERO);
+    world_loadPendingChunks(&world);
+
+    report("region fill", timeRegion(&world, BL_STONE));
+    report("region clear", timeRegion(&world, BL_AIR));
+    report("single fill", timeSingle(&world, BL_STONE));
+    report("single clear", timeSingle(&world, BL_AIR));
+
+    world_free(&world);
+
+    return 0;
+}
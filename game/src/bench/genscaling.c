@@ -0,0 +1,43 @@
+#include <logging.h>
+#include <unistd.h>
+#include "bench.h"
+#include "world.h"
+
+/*
+ * Times loading the chunks around the spawn from nothing with every number of
+ * generation threads from one up to the number of cores, to show how chunk
+ * generation and meshing scale across the job pool.
+ */
+
+int main(void) {
+    log_init(stdout);
+    bench_initContext();
+
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    double baseline = 0;
+    for (int threads = 1; threads <= cores; threads++) {
+        world_t world;
+        world_init(&world, 40);
+        world_setGenerationThreads(&world, threads);
+
+        unsigned int spawnLoader;
+        world_genChunkLoader(&world, &spawnLoader);
+        world_updateChunkLoader(&world, spawnLoader, GLM_VEC3_ZERO);
+
+        const double start = bench_now();
+        world_loadPendingChunks(&world);
+        const double elapsed = bench_now() - start;
+
+        if (threads == 1) {
+            baseline = elapsed;
+        }
+        const size_t chunks = world_getMemoryStats(&world).chunks.live;
+        LOG_INFO("%2d threads: %zu chunks in %.1f ms, %.0f chunks/s, %.2fx, first chunk meshed after %.1f ms",
+                 threads, chunks, elapsed * 1e3, chunks / elapsed, baseline / elapsed,
+                 world_getFirstVisibleTime(&world) * 1e3);
+
+        world_free(&world);
+    }
+
+    return 0;
+}
@@ -0,0 +1,247 @@
+#include <inttypes.h>
+#include <logging.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "world.h"
+
+/*
+ * Checks that world generation is deterministic and hasn't changed. For each of a
+ * few seeds, loads the chunks around the origin with a range of generation thread
+ * counts, hashes the blocks of every chunk near the origin and compares the hashes
+ * against the golden values in golden.txt. An optimisation of the noise, terrain
+ * generation or decoration that changes any world fails here, as does anything
+ * that makes the result depend on the number of threads. Every load is timed, so
+ * this doubles as a generation benchmark.
+ *
+ * Run with --record to rewrite golden.txt after an intended change to generation.
+ */
+
+/// The view distance the chunks are loaded with
+#define GOLDEN_VIEW_DISTANCE 5
+/// The chunks hashed are those up to this many chunks from the origin along each
+/// axis, well inside the view distance so decorations from beyond it can't reach them
+#define HASH_RADIUS 2
+#define HASH_WIDTH (2 * HASH_RADIUS + 1)
+#define N_HASHES (HASH_WIDTH * HASH_WIDTH * HASH_WIDTH)
+
+/// Every thread count up to this is checked, however many cores there are
+#define MIN_THREADS 8
+
+#define FNV_OFFSET 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+static const uint64_t seeds[] = { 40, 1, 0x5EED, 0xC0FFEE, 123456789 };
+#define N_SEEDS (sizeof(seeds) / sizeof(seeds[0]))
+
+/// The golden hashes, indexed by seed then by chunk
+static uint64_t golden[N_SEEDS][N_HASHES];
+
+/**
+ * @brief Gets the index of a hashed chunk
+ */
+static int hashIndex(const int cx, const int cy, const int cz) {
+    return ((cx + HASH_RADIUS) * HASH_WIDTH + (cy + HASH_RADIUS)) * HASH_WIDTH + (cz + HASH_RADIUS);
+}
+
+/**
+ * @brief Hashes the blocks of a chunk
+ * @param w A pointer to a world, within a read section
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ * @param hash Where to store the hash
+ * @return Whether the chunk was loaded
+ */
+static bool hashChunk(const world_t *w, const int cx, const int cy, const int cz, uint64_t *hash) {
+    const ivec3 min = { cx * CHUNK_SIZE, cy * CHUNK_SIZE, cz * CHUNK_SIZE };
+    const ivec3 max = { min[0] + CHUNK_SIZE, min[1] + CHUNK_SIZE, min[2] + CHUNK_SIZE };
+    worldSpan_t s;
+    world_spanBegin(w, &s, min, max);
+
+    uint64_t h = FNV_OFFSET;
+    while (world_spanNext(&s)) {
+        if (!s.chunk) return false;
+        for (int i = 0; i < s.length; i++) {
+            h = (h ^ (uint64_t)worldSpan_get(&s, i)) * FNV_PRIME;
+        }
+    }
+    *hash = h;
+    return true;
+}
+
+/**
+ * @brief Loads the chunks around the origin and hashes those near it
+ * @param seed The world seed
+ * @param threads The number of generation threads
+ * @param hashes Where to store the hashes
+ * @return The seconds loading took, or a negative number if a hashed chunk wasn't loaded
+ */
+static double generate(const uint64_t seed, const int threads, uint64_t hashes[N_HASHES]) {
+    world_t world;
+    world_init(&world, seed);
+    world_setViewDistance(&world, GOLDEN_VIEW_DISTANCE);
+    world_setGenerationThreads(&world, threads);
+
+    unsigned int loader;
+    world_genChunkLoader(&world, &loader);
+    world_updateChunkLoader(&world, loader, GLM_VEC3_ZERO);
+
+    const double start = bench_now();
+    world_loadPendingChunks(&world);
+    double elapsed = bench_now() - start;
+
+    world_beginRead(&world);
+    for (int cx = -HASH_RADIUS; cx <= HASH_RADIUS; cx++) {
+        for (int cy = -HASH_RADIUS; cy <= HASH_RADIUS; cy++) {
+            for (int cz = -HASH_RADIUS; cz <= HASH_RADIUS; cz++) {
+                if (!hashChunk(&world, cx, cy, cz, &hashes[hashIndex(cx, cy, cz)])) {
+                    LOG_ERROR("Chunk %d %d %d wasn't loaded", cx, cy, cz);
+                    elapsed = -1;
+                }
+            }
+        }
+    }
+    world_endRead(&world);
+
+    world_free(&world);
+    return elapsed;
+}
+
+/**
+ * @brief Reads the golden hashes
+ * @return Whether every hash was found
+ */
+static bool readGolden(void) {
+    FILE *fp = fopen(GOLDEN_FILE, "r");
+    if (!fp) {
+        LOG_ERROR("Couldn't open %s, run with --record to create it", GOLDEN_FILE);
+        return false;
+    }
+
+    static bool found[N_SEEDS][N_HASHES];
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        uint64_t seed, hash;
+        int cx, cy, cz;
+        if (line[0] == '#' || sscanf(line, "%" SCNu64 " %d %d %d %" SCNx64, &seed, &cx, &cy, &cz, &hash) != 5) {
+            continue;
+        }
+        if (cx < -HASH_RADIUS || cx > HASH_RADIUS || cy < -HASH_RADIUS || cy > HASH_RADIUS ||
+            cz < -HASH_RADIUS || cz > HASH_RADIUS) {
+            continue;
+        }
+        for (size_t s = 0; s < N_SEEDS; s++) {
+            if (seeds[s] != seed) continue;
+            golden[s][hashIndex(cx, cy, cz)] = hash;
+            found[s][hashIndex(cx, cy, cz)] = true;
+        }
+    }
+    fclose(fp);
+
+    for (size_t s = 0; s < N_SEEDS; s++) {
+        for (int i = 0; i < N_HASHES; i++) {
+            if (!found[s][i]) {
+                LOG_ERROR("%s is missing hashes for seed %" PRIu64 ", run with --record to update it",
+                          GOLDEN_FILE, seeds[s]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes hashes as the new golden hashes
+ * @param hashes The hashes, indexed by seed then by chunk
+ * @return Whether they were written
+ */
+static bool writeGolden(uint64_t hashes[N_SEEDS][N_HASHES]) {
+    FILE *fp = fopen(GOLDEN_FILE, "w");
+    if (!fp) {
+        LOG_ERROR("Couldn't open %s for writing", GOLDEN_FILE);
+        return false;
+    }
+    fprintf(fp, "# Golden chunk block hashes, checked by bench-golden and rewritten by bench-golden --record\n");
+    fprintf(fp, "# seed cx cy cz hash\n");
+    for (size_t s = 0; s < N_SEEDS; s++) {
+        for (int cx = -HASH_RADIUS; cx <= HASH_RADIUS; cx++) {
+            for (int cy = -HASH_RADIUS; cy <= HASH_RADIUS; cy++) {
+                for (int cz = -HASH_RADIUS; cz <= HASH_RADIUS; cz++) {
+                    fprintf(fp, "%" PRIu64 " %d %d %d %016" PRIx64 "\n",
+                            seeds[s], cx, cy, cz, hashes[s][hashIndex(cx, cy, cz)]);
+                }
+            }
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+int main(const int argc, char **argv) {
+    log_init(stdout);
+
+    const bool record = argc > 1 && strcmp(argv[1], "--record") == 0;
+    if (!record && !readGolden()) {
+        return 1;
+    }
+
+    // Powers of two up to MIN_THREADS even on fewer cores, since batches are split the
+    // same way whether or not the threads actually run at once, then every core
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threadCounts[32];
+    int nThreadCounts = 0;
+    for (int t = 1; (t <= MIN_THREADS || t < cores) && nThreadCounts < 31; t *= 2) {
+        threadCounts[nThreadCounts++] = t;
+    }
+    if (cores > threadCounts[nThreadCounts - 1]) {
+        threadCounts[nThreadCounts++] = (int)cores;
+    }
+
+    static uint64_t hashes[N_SEEDS][N_HASHES];
+    bool ok = true;
+    double total = 0;
+    for (size_t s = 0; s < N_SEEDS; s++) {
+        for (int t = 0; t < nThreadCounts; t++) {
+            uint64_t run[N_HASHES];
+            const double elapsed = generate(seeds[s], threadCounts[t], run);
+            if (elapsed < 0) {
+                ok = false;
+                continue;
+            }
+            total += elapsed;
+
+            // Every run is checked against the first for the seed, so a recording is
+            // only written if the thread count made no difference
+            if (t == 0) {
+                memcpy(hashes[s], run, sizeof(run));
+            }
+            const uint64_t *expected = record ? hashes[s] : golden[s];
+            int mismatches = 0;
+            for (int i = 0; i < N_HASHES; i++) {
+                mismatches += run[i] != expected[i];
+            }
+            if (mismatches > 0) {
+                ok = false;
+            }
+            LOG_INFO("seed %-10" PRIu64 " %2d threads: %.1f ms, %s",
+                     seeds[s], threadCounts[t], elapsed * 1e3, mismatches == 0 ? "ok" : "MISMATCH");
+            if (mismatches > 0) {
+                LOG_ERROR("%d of %d chunks differ from the %s", mismatches, N_HASHES,
+                          record ? "single threaded run" : "golden hashes");
+            }
+        }
+    }
+    LOG_INFO("%zu seeds across %d thread counts in %.2f s", N_SEEDS, nThreadCounts, total);
+
+    if (!ok) {
+        LOG_ERROR("World generation is %s", record ? "not deterministic, nothing recorded" : "different");
+        return 1;
+    }
+    if (record) {
+        if (!writeGolden(hashes)) return 1;
+        LOG_INFO("Recorded the golden hashes in %s", GOLDEN_FILE);
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include <logging.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include "bench.h"
+#include "settings.h"
+#include "world.h"
+
+/*
+ * Runs the whole chunk pipeline without a window, a GL context or an audio device:
+ * a chunk loader follows a scripted path and every tick runs one chunk loading pass,
+ * then takes the finished meshes as the render thread would. Prints chunks per
+ * second, latency percentiles for each stage of a pass and peak memory, so
+ * throughput can be tracked across changes on any machine. Takes the same
+ * settings as the game, such as --gen-threads and --view-distance.
+ */
+
+/// The number of ticks the loader is driven for
+#define TICKS 2000
+/// How far the loader moves each tick, in blocks
+#define BLOCKS_PER_TICK 2.f
+/// The seconds a tick stands for, which turns the step into a velocity for prefetching
+#define TICK_SECONDS (1.f / 60.f)
+
+/// The corners of the path, which is followed in order and then back to the start
+static const vec3 waypoints[] = {
+    { 0.f, 16.f, 0.f },
+    { 640.f, 16.f, 0.f },
+    { 640.f, 48.f, 640.f },
+    { 0.f, 16.f, 640.f },
+};
+#define N_WAYPOINTS (sizeof(waypoints) / sizeof(waypoints[0]))
+
+/**
+ * @brief The durations of one stage over every pass it did work in
+ */
+typedef struct {
+    const char *name;
+    double *seconds;
+    size_t n;
+    /// The items the stage worked through over every pass
+    size_t items;
+} stageSamples_t;
+
+static int compareDoubles(const void *a, const void *b) {
+    const double da = *(const double *)a;
+    const double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+/**
+ * @brief Records a pass of a stage, unless it had nothing to do
+ * @param s A pointer to the stage's samples
+ * @param seconds How long the stage took
+ * @param items The number of chunks or meshes it worked through
+ */
+static void recordStage(stageSamples_t *s, const double seconds, const size_t items) {
+    if (items == 0) return;
+    s->seconds[s->n++] = seconds;
+    s->items += items;
+}
+
+/**
+ * @brief Logs the latency percentiles of a stage
+ * @param s A pointer to the stage's samples, which are sorted
+ */
+static void reportStage(stageSamples_t *s) {
+    if (s->n == 0) {
+        LOG_INFO("%-9s no passes", s->name);
+        return;
+    }
+    qsort(s->seconds, s->n, sizeof(double), compareDoubles);
+    double total = 0;
+    for (size_t i = 0; i < s->n; i++) {
+        total += s->seconds[i];
+    }
+    LOG_INFO("%-9s %5zu passes, p50 %7.2f ms, p90 %7.2f ms, p99 %7.2f ms, max %7.2f ms, %6.1f us per item",
+             s->name, s->n,
+             s->seconds[s->n / 2] * 1e3,
+             s->seconds[s->n * 9 / 10] * 1e3,
+             s->seconds[s->n * 99 / 100] * 1e3,
+             s->seconds[s->n - 1] * 1e3,
+             total * 1e6 / (double)s->items);
+}
+
+/**
+ * @brief Moves a position along the path
+ * @param pos The position, updated in place
+ * @param target A pointer to the index of the waypoint being headed for, advanced on arrival
+ * @param velocity Where to store the velocity in blocks per second
+ */
+static void followPath(vec3 pos, size_t *target, vec3 velocity) {
+    vec3 step;
+    glm_vec3_sub((float *)waypoints[*target], pos, step);
+    const float remaining = glm_vec3_norm(step);
+    if (remaining <= BLOCKS_PER_TICK) {
+        glm_vec3_copy((float *)waypoints[*target], pos);
+        *target = (*target + 1) % N_WAYPOINTS;
+    } else {
+        glm_vec3_scale_as(step, BLOCKS_PER_TICK, step);
+        glm_vec3_add(pos, step, pos);
+    }
+    glm_vec3_scale(step, 1.f / TICK_SECONDS, velocity);
+}
+
+int main(const int argc, char **argv) {
+    log_init(stdout);
+
+    settings_t settings;
+    settings_load(&settings, argc, argv);
+
+    world_t world;
+    world_init(&world, 40);
+    world_setViewDistance(&world, settings.viewDistance);
+    world_setMemoryBudget(&world, settings.memoryBudget);
+    world_setGenerationThreads(&world, settings.generationThreads);
+    world_setLodDistance(&world, settings.lodDistance);
+    world_setTerrainSampling(&world, settings.coarseTerrain ? TERRAIN_COARSE : TERRAIN_EXACT);
+
+    unsigned int loader;
+    world_genChunkLoader(&world, &loader);
+    vec3 pos;
+    glm_vec3_copy((float *)waypoints[0], pos);
+    size_t target = 1;
+
+    stageSamples_t stages[] = {
+        { .name = "generate" },
+        { .name = "decorate" },
+        { .name = "light" },
+        { .name = "mesh" },
+    };
+    for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+        stages[i].seconds = malloc(TICKS * sizeof(double));
+        if (!stages[i].seconds) {
+            LOG_FATAL("Stage sample allocation failed");
+        }
+    }
+
+    size_t peakBudgeted = 0;
+    size_t uploaded = 0;
+    const double start = bench_now();
+    for (int tick = 0; tick < TICKS; tick++) {
+        vec3 velocity;
+        followPath(pos, &target, velocity);
+        world_updateChunkLoaderPrefetch(&world, loader, pos, velocity);
+
+        world_doChunkLoading(&world);
+        const worldPassTimes_t times = world_getPassTimes(&world);
+        recordStage(&stages[0], times.generate, times.generated);
+        recordStage(&stages[1], times.decorate, times.generated);
+        // Light is propagated in every pass, so it is counted against the chunks meshed after it
+        recordStage(&stages[2], times.light, times.meshed);
+        recordStage(&stages[3], times.mesh, times.meshed);
+
+        world_beginRead(&world);
+        world_remeshChunks(&world, pos);
+        uploaded += world_getUploadStats(&world).uploaded;
+        world_endRead(&world);
+
+        const size_t budgeted = world_getMemoryStats(&world).budgetedBytes;
+        if (budgeted > peakBudgeted) {
+            peakBudgeted = budgeted;
+        }
+    }
+    const double elapsed = bench_now() - start;
+
+    const worldLoadStats_t loadStats = world_getLoadStats(&world);
+    LOG_INFO("%d ticks in %.2f s with %d threads: %zu chunks generated, %.0f chunks/s, %zu meshes taken",
+             TICKS, elapsed, settings.generationThreads, loadStats.generated,
+             (double)loadStats.generated / elapsed, uploaded);
+    LOG_INFO("%zu chunks above the terrain and %zu below it skipped generating each block",
+             loadStats.airChunks, loadStats.stoneChunks);
+    for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+        reportStage(&stages[i]);
+        free(stages[i].seconds);
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    // ru_maxrss is in KiB on Linux
+    LOG_INFO("Peak memory: %.1f MiB resident, %.1f MiB budgeted world memory",
+             (double)usage.ru_maxrss / 1024.0, (double)peakBudgeted / (1024.0 * 1024.0));
+
+    world_free(&world);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <logging.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "lighting.h"
+#include "world.h"
+
+/*
+ * Times the two passes that depend on how chunk storage is walked: meshing, whose
+ * input capture unpacks the blocks and reads the light map, and the sunlight flood
+ * fill from a cleared light map, which reads light by neighbour rather than in order. Build once with and
+ * once without CHUNK_MORTON_LAYOUT to compare the block storage layouts.
+ */
+
+#define REPEATS 5
+
+#ifdef CHUNK_MORTON_LAYOUT
+#define LAYOUT_NAME "morton"
+#else
+#define LAYOUT_NAME "linear"
+#endif
+
+/**
+ * @brief Relights a set of chunks from scratch with sunlight
+ * @param w A pointer to a world
+ * @param chunks The chunks
+ * @param nChunks The number of chunks
+ */
+static void relight(world_t *w, chunk_t **chunks, const int nChunks) {
+    for (int i = 0; i < nChunks; i++) {
+        memset(chunks[i]->lightMap, 0, sizeof(chunks[i]->lightMap));
+        queue_clear(&chunks[i]->lightSunInsertionQueue);
+        queue_clear(&chunks[i]->lightTorchInsertionQueue);
+        chunk_initSun(chunks[i]);
+    }
+
+    // Light spills into neighbouring chunks, so keep going until every queue is empty
+    bool pending = true;
+    while (pending) {
+        pending = false;
+        for (int i = 0; i < nChunks; i++) {
+            chunk_t *c = chunks[i];
+            if (c->lightSunInsertionQueue.size > 0 || c->lightTorchInsertionQueue.size > 0) {
+                chunk_processLightInsertion(c, w);
+                pending = true;
+            }
+        }
+    }
+}
+
+int main(void) {
+    log_init(stdout);
+    bench_initContext();
+
+    world_t world;
+    world_init(&world, 40);
+
+    unsigned int spawnLoader;
+    world_genChunkLoader(&world, &spawnLoader);
+    world_updateChunkLoader(&world, spawnLoader, GLM_VEC3_ZERO);
+    world_loadPendingChunks(&world);
+
+    const int r = CHUNK_LOAD_RADIUS;
+    chunk_t **chunks = malloc((2 * r + 1) * (2 * r + 1) * (2 * r + 1) * sizeof(chunk_t *));
+    int nChunks = 0;
+    for (int x = -r; x <= r; x++) {
+        for (int y = -r; y <= r; y++) {
+            for (int z = -r; z <= r; z++) {
+                chunk_t *c = world_getFullyLoadedChunk(&world, x, y, z);
+                if (!c) continue;
+                chunks[nChunks++] = c;
+            }
+        }
+    }
+
+    meshInput_t *input = malloc(sizeof(meshInput_t));
+    long long vertices = 0;
+    double start = bench_now();
+    for (int i = 0; i < REPEATS; i++) {
+        for (int j = 0; j < nChunks; j++) {
+            chunkMesh_capture(input, chunks[j], 1, 0);
+            chunkMesh_t *m = chunkMesh_build(input);
+            vertices += m->nVertices;
+            chunkMesh_free(m);
+        }
+    }
+    const double meshElapsed = bench_now() - start;
+
+    start = bench_now();
+    for (int i = 0; i < REPEATS; i++) {
+        relight(&world, chunks, nChunks);
+    }
+    const double lightElapsed = bench_now() - start;
+
+    LOG_INFO("%s layout, %d chunks x%d: meshing %.1f us per chunk (%lld vertices), "
+             "chunk_processLightInsertion %.1f us per chunk",
+             LAYOUT_NAME, nChunks, REPEATS,
+             meshElapsed * 1e6 / (REPEATS * nChunks),
+             vertices / REPEATS,
+             lightElapsed * 1e6 / (REPEATS * nChunks));
+
+    free(input);
+    free(chunks);
+    world_free(&world);
+
+    return 0;
+}
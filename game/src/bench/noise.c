@@ -0,0 +1,77 @@
+#include <logging.h>
+#include <string.h>
+#include "bench.h"
+#include "chunk.h"
+#include "noise.h"
+
+/*
+ * Compares evaluating the terrain noise one point at a time against the batch
+ * functions, over the block columns of a square of chunk columns, which is how
+ * terrain generation uses it. Checks the batch results are bit-identical to the
+ * scalar ones and prints points per second for both.
+ */
+
+/// The number of chunk columns across the square
+#define COLUMNS 16
+#define POINTS (COLUMNS * COLUMNS * CHUNK_SIZE * CHUNK_SIZE)
+#define REPEATS 10
+
+/// The fbm parameters of the terrain height noises
+static const struct {
+    int octaves;
+    float persistence;
+    float baseFrequency;
+} layers[] = {
+    { 2, 0.5f, 0.005f },
+    { 5, 0.4f, 0.01f },
+    { 3, 0.4f, 0.01f },
+};
+#define N_LAYERS (sizeof(layers) / sizeof(layers[0]))
+
+static float xs[POINTS];
+static float ys[POINTS];
+static float scalarOut[POINTS];
+static float batchOut[POINTS];
+
+int main(void) {
+    log_init(stdout);
+
+    noise_t noise = { .seed = 0x9E3779B9u };
+    // Centred on the origin, so both signs of coordinate are covered
+    for (int i = 0; i < POINTS; i++) {
+        xs[i] = (float)(i % (COLUMNS * CHUNK_SIZE) - COLUMNS * CHUNK_SIZE / 2);
+        ys[i] = (float)(i / (COLUMNS * CHUNK_SIZE) - COLUMNS * CHUNK_SIZE / 2);
+    }
+
+    double scalarTime = 0;
+    double batchTime = 0;
+    bool identical = true;
+    for (int r = 0; r < REPEATS; r++) {
+        for (size_t l = 0; l < N_LAYERS; l++) {
+            double start = bench_now();
+            for (int i = 0; i < POINTS; i++) {
+                scalarOut[i] = noise_fbm(&noise, xs[i], ys[i],
+                                         layers[l].octaves, layers[l].persistence, layers[l].baseFrequency);
+            }
+            scalarTime += bench_now() - start;
+
+            start = bench_now();
+            noise_fbmBatch(&noise, xs, ys, POINTS,
+                           layers[l].octaves, layers[l].persistence, layers[l].baseFrequency, batchOut);
+            batchTime += bench_now() - start;
+
+            identical = identical && memcmp(scalarOut, batchOut, sizeof(scalarOut)) == 0;
+        }
+    }
+
+    const double points = (double)POINTS * N_LAYERS * REPEATS;
+    LOG_INFO("scalar: %.2f Mpoints/s", points / scalarTime * 1e-6);
+    LOG_INFO("batch:  %.2f Mpoints/s, %.2fx", points / batchTime * 1e-6, scalarTime / batchTime);
+    if (!identical) {
+        LOG_ERROR("Batch results differ from the scalar ones");
+        return 1;
+    }
+    LOG_INFO("Batch results are bit-identical");
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <logging.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "world.h"
+
+/*
+ * Times meshing every chunk of a freshly loaded spawn area, capturing each chunk's
+ * blocks and light with a border from its neighbours and then building the mesh,
+ * at each level of detail to compare their vertex counts.
+ */
+
+#define REPEATS 5
+
+int main(void) {
+    log_init(stdout);
+    bench_initContext();
+
+    world_t world;
+    world_init(&world, 40);
+
+    unsigned int spawnLoader;
+    world_genChunkLoader(&world, &spawnLoader);
+    world_updateChunkLoader(&world, spawnLoader, GLM_VEC3_ZERO);
+    world_loadPendingChunks(&world);
+
+    const int r = CHUNK_LOAD_RADIUS;
+    chunk_t **chunks = malloc((2 * r + 1) * (2 * r + 1) * (2 * r + 1) * sizeof(chunk_t *));
+    int nChunks = 0;
+    for (int x = -r; x <= r; x++) {
+        for (int y = -r; y <= r; y++) {
+            for (int z = -r; z <= r; z++) {
+                chunk_t *c = world_getFullyLoadedChunk(&world, x, y, z);
+                if (!c) continue;
+                chunks[nChunks++] = c;
+            }
+        }
+    }
+
+    meshInput_t *input = malloc(sizeof(meshInput_t));
+    for (int lod = 1; lod <= MAX_MESH_LOD; lod *= 2) {
+        long long vertices = 0;
+        const double start = bench_now();
+        for (int i = 0; i < REPEATS; i++) {
+            for (int j = 0; j < nChunks; j++) {
+                chunkMesh_capture(input, chunks[j], lod, 0);
+                chunkMesh_t *m = chunkMesh_build(input);
+                vertices += m->nVertices;
+                chunkMesh_free(m);
+            }
+        }
+        const double elapsed = bench_now() - start;
+
+        LOG_INFO("Remeshed %d chunks x%d at LOD %d: %.3f ms per pass, %.1f us per chunk, %lld vertices",
+                 nChunks, REPEATS, lod,
+                 elapsed * 1e3 / REPEATS,
+                 elapsed * 1e6 / (REPEATS * nChunks),
+                 vertices / REPEATS);
+    }
+
+    free(input);
+    free(chunks);
+    world_free(&world);
+
+    return 0;
+}
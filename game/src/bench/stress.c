@@ -0,0 +1,125 @@
+#include <logging.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "world.h"
+
+/*
+ * Drives the chunk loading thread and the render thread against the same world at
+ * once: the render thread moves a chunk loader in a straight line so chunks are
+ * constantly loaded and unloaded, and every frame reads blocks, raycasts, uploads
+ * meshes and queues edits. Build with BENCH_TSAN to run it under ThreadSanitizer.
+ */
+
+#define FRAMES 3000
+#define LOADER_SPEED 1.5f
+#define READS_PER_FRAME 256
+
+struct loaderData {
+    atomic_bool run;
+    world_t *world;
+};
+
+static void *loaderThread(void *arg) {
+    struct loaderData *data = arg;
+    while (atomic_load_explicit(&data->run, memory_order_acquire)) {
+        world_waitForChunkWork(data->world);
+        world_doChunkLoading(data->world);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Checks that every chunk in the render thread's snapshot can be found again
+ * @param w A pointer to a world
+ * @return Whether the snapshot is consistent
+ */
+static bool checkSnapshot(const world_t *w) {
+    const chunkSnapshot_t *s = w->readSnapshot;
+    for (size_t i = 0; i < s->count; i++) {
+        const chunk_t *c = s->chunks[i];
+        if (chunkSnapshot_get(s, c->cx, c->cy, c->cz) != c) {
+            LOG_ERROR("Snapshot lookup of chunk %d %d %d failed", c->cx, c->cy, c->cz);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    log_init(stdout);
+    bench_initContext();
+
+    world_t world;
+    world_init(&world, 40);
+
+    unsigned int loader;
+    world_genChunkLoader(&world, &loader);
+    vec3 pos = { 0.f, 20.f, 0.f };
+    world_updateChunkLoader(&world, loader, pos);
+
+    struct loaderData data = { .world = &world };
+    atomic_store_explicit(&data.run, true, memory_order_release);
+    pthread_t th;
+    pthread_create(&th, NULL, loaderThread, &data);
+
+    rng_t rng;
+    rng_init(&rng, 1234);
+
+    long long reads = 0;
+    long long edits = 0;
+    bool ok = true;
+    const double start = bench_now();
+    for (int frame = 0; frame < FRAMES && ok; frame++) {
+        pos[0] += LOADER_SPEED;
+        world_updateChunkLoader(&world, loader, pos);
+
+        world_beginRead(&world);
+        ok = checkSnapshot(&world);
+
+        for (int i = 0; i < READS_PER_FRAME; i++) {
+            blockData_t bd;
+            const int x = (int)pos[0] + (int)rng_floatRange(&rng, -96.f, 96.f);
+            const int y = (int)rng_floatRange(&rng, -32.f, 64.f);
+            const int z = (int)rng_floatRange(&rng, -96.f, 96.f);
+            reads += world_getBlocki(&world, x, y, z, &bd);
+        }
+
+        vec3 eye = { pos[0], pos[1], pos[2] };
+        vec3 down = { rng_floatRange(&rng, -1.f, 1.f), -1.f, rng_floatRange(&rng, -1.f, 1.f) };
+        const raycast_t ray = world_raycast(&world, eye, down, 40.f);
+        if (ray.found) {
+            const int x = (int)ray.blockPosition[0];
+            const int y = (int)ray.blockPosition[1];
+            const int z = (int)ray.blockPosition[2];
+            edits += world_removeBlock(&world, x, y, z);
+            edits += world_placeBlock(&world, x, y + 1, z, BL_GLOWSTONE);
+        }
+
+        world_remeshChunks(&world, eye);
+        world_endRead(&world);
+
+        main_thread_free(&world.queues.chunkBufferFreeQueue);
+        while (world.numEntities > 0) {
+            world_removeItemEntity(&world, world.numEntities - 1);
+        }
+    }
+    const double elapsed = bench_now() - start;
+
+    atomic_store_explicit(&data.run, false, memory_order_release);
+    world_wakeChunkLoading(&world);
+    pthread_join(th, NULL);
+
+    const worldMemoryStats_t stats = world_getMemoryStats(&world);
+    LOG_INFO("%d frames in %.2f s: %lld block reads hit, %lld edits queued, %zu objects awaiting reclaim, %zu live chunks",
+             FRAMES, elapsed, reads, edits, epoch_pending(&world.epoch), stats.chunks.live);
+    const worldLoadStats_t loadStats = world_getLoadStats(&world);
+    LOG_INFO("%zu chunks generated, %zu retained, %zu regenerations avoided",
+             loadStats.generated, loadStats.retained, loadStats.regenerationsAvoided);
+
+    main_thread_free(&world.queues.chunkBufferFreeQueue);
+    world_free(&world);
+
+    return ok ? 0 : 1;
+}
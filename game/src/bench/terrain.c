@@ -0,0 +1,81 @@
+#include <cglm/cglm.h>
+#include <logging.h>
+#include <math.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "chunk.h"
+#include "noise.h"
+
+/*
+ * Compares sampling the terrain noise at every block column against sampling it on
+ * the coarse lattice and interpolating. Computes the same square of chunk columns
+ * both ways, then prints columns per second for each and how far the coarse
+ * heights and biome offsets stray from the exact ones.
+ */
+
+/// The number of chunk columns across the square
+#define COLUMNS 32
+#define N_COLUMNS (COLUMNS * COLUMNS)
+#define REPEATS 5
+
+/**
+ * @brief Computes every column of the square
+ * @param columns The columns to fill in
+ * @param noise A pointer to a noise object
+ * @param sampling How to sample the noise
+ * @return The columns computed per second
+ */
+static double generateAll(chunkColumn_t *columns, noise_t *noise, const terrainSampling_e sampling) {
+    const double start = bench_now();
+    for (int r = 0; r < REPEATS; r++) {
+        for (int i = 0; i < N_COLUMNS; i++) {
+            chunk_generateColumn(&columns[i], noise, i % COLUMNS - COLUMNS / 2, i / COLUMNS - COLUMNS / 2, sampling);
+        }
+    }
+    return (double)N_COLUMNS * REPEATS / (bench_now() - start);
+}
+
+int main(void) {
+    log_init(stdout);
+
+    chunkColumn_t *exact = malloc(N_COLUMNS * sizeof(chunkColumn_t));
+    chunkColumn_t *coarse = malloc(N_COLUMNS * sizeof(chunkColumn_t));
+    if (!exact || !coarse) {
+        LOG_FATAL("Column allocation failed");
+    }
+
+    noise_t noise = { .seed = 0x9E3779B9u };
+    const double exactRate = generateAll(exact, &noise, TERRAIN_EXACT);
+    const double coarseRate = generateAll(coarse, &noise, TERRAIN_COARSE);
+
+    int maxHeightError = 0;
+    long long totalHeightError = 0;
+    int heightsDiffering = 0;
+    float maxHumidityError = 0.f;
+    float maxTemperatureError = 0.f;
+    for (int i = 0; i < N_COLUMNS; i++) {
+        for (int b = 0; b < CHUNK_SIZE * CHUNK_SIZE; b++) {
+            const int heightError = abs(coarse[i].height[b] - exact[i].height[b]);
+            maxHeightError = glm_imax(maxHeightError, heightError);
+            totalHeightError += heightError;
+            heightsDiffering += heightError > 0;
+            maxHumidityError = glm_max(maxHumidityError,
+                                       fabsf(coarse[i].humidityOffset[b] - exact[i].humidityOffset[b]));
+            maxTemperatureError = glm_max(maxTemperatureError,
+                                          fabsf(coarse[i].temperatureOffset[b] - exact[i].temperatureOffset[b]));
+        }
+    }
+
+    const int blockColumns = N_COLUMNS * CHUNK_SIZE * CHUNK_SIZE;
+    LOG_INFO("exact:  %.0f columns/s", exactRate);
+    LOG_INFO("coarse: %.0f columns/s, %.2fx", coarseRate, coarseRate / exactRate);
+    LOG_INFO("Height: max deviation %d blocks, mean %.3f blocks, %.1f%% of block columns differ",
+             maxHeightError, (double)totalHeightError / blockColumns, 100.0 * heightsDiffering / blockColumns);
+    LOG_INFO("Humidity offset: max deviation %.3f, temperature offset: max deviation %.3f",
+             maxHumidityError, maxTemperatureError);
+
+    free(exact);
+    free(coarse);
+
+    return 0;
+}
@@ -3,7 +3,10 @@
 
 #include <cglm/cglm.h>
 
+// Headless builds run without a window or an audio device
+#ifndef WORLD_HEADLESS
 #define ENABLE_AUDIO
+#endif
 
 typedef enum {
     BL_AIR,
@@ -0,0 +1,257 @@
+#include <logging.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "blockpalette.h"
+
+/*
+ * The data of every uniform palette: a width byte of 0, then a single index byte.
+ * With 0 bits per index the index mask is 0, so blockPalette_get always reads entry 0
+ * without needing a branch, but it still reads the first index byte, which this provides.
+ */
+static _Atomic uint8_t uniformData[2];
+
+static size_t dataBytes(const int bits) {
+    return BLOCK_PALETTE_VOLUME * bits / 8;
+}
+
+/**
+ * @brief Allocates a zeroed buffer of packed indices, after a byte holding its width
+ * @param bits The number of bits per index, greater than 0
+ * @return A pointer to the first index byte
+ */
+static _Atomic uint8_t *allocData(const int bits) {
+    _Atomic uint8_t *data = calloc(dataBytes(bits) + 1, 1);
+    if (!data) {
+        LOG_FATAL("blockPalette data allocation failed");
+    }
+    atomic_init(&data[0], (uint8_t)bits);
+    return data + 1;
+}
+
+/**
+ * @brief Frees a buffer of packed indices, unless it is the uniform placeholder
+ * @param data A pointer to the first index byte
+ */
+static void freeData(_Atomic uint8_t *data) {
+    const int bits = atomic_load_explicit(&data[-1], memory_order_relaxed);
+    if (bits == 0) return;
+    free((void *)(data - 1));
+}
+
+/**
+ * @brief Counts indices of a given width in or out of a palette's statistics
+ * @param p A pointer to a palette
+ * @param bits The number of bits per index, 0 for a uniform palette
+ * @param add Whether to count them in rather than out
+ */
+static void count(const blockPalette_t *p, const int bits, const bool add) {
+    if (!p->stats) return;
+    atomic_size_t *counter = bits == 0 ? &p->stats->uniform : &p->stats->bytes;
+    const size_t amount = bits == 0 ? 1 : dataBytes(bits);
+    if (add) {
+        atomic_fetch_add_explicit(counter, amount, memory_order_relaxed);
+    } else {
+        atomic_fetch_sub_explicit(counter, amount, memory_order_relaxed);
+    }
+}
+
+static _Atomic uint8_t *getData(const blockPalette_t *p) {
+    return atomic_load_explicit(&p->data, memory_order_relaxed);
+}
+
+/**
+ * @brief Replaces a palette's packed indices with zeroed ones of a new width
+ * @param p A pointer to a palette that no reader can reach
+ * @param bits The new number of bits per index, or 0 to make the palette uniform
+ */
+static void resetData(blockPalette_t *p, const int bits) {
+    _Atomic uint8_t *data = getData(p);
+    if (bits == p->bits) {
+        for (size_t i = 0; i < dataBytes(bits); i++) {
+            atomic_store_explicit(&data[i], 0, memory_order_relaxed);
+        }
+        return;
+    }
+    count(p, p->bits, false);
+    count(p, bits, true);
+    freeData(data);
+    atomic_store_explicit(&p->data, bits == 0 ? uniformData + 1 : allocData(bits), memory_order_release);
+    p->bits = (uint8_t)bits;
+}
+
+/*
+ * Only the writer modifies index bytes, so a relaxed load followed by a release store
+ * is enough. The release store makes sure a reader that sees a new index also sees
+ * the entry it points at.
+ */
+static void writeIndex(_Atomic uint8_t *data, const int bits, const int i, const int index) {
+    const int bit = i * bits;
+    const int mask = ((1 << bits) - 1) << (bit & 7);
+    const uint8_t old = atomic_load_explicit(&data[bit >> 3], memory_order_relaxed);
+    atomic_store_explicit(&data[bit >> 3], (uint8_t)((old & ~mask) | (index << (bit & 7))), memory_order_release);
+}
+
+static int readIndex(_Atomic uint8_t *data, const int bits, const int i) {
+    const int bit = i * bits;
+    return (atomic_load_explicit(&data[bit >> 3], memory_order_relaxed) >> (bit & 7)) & ((1 << bits) - 1);
+}
+
+static block_t getEntry(const blockPalette_t *p, const int index) {
+    return (block_t)atomic_load_explicit(&p->entries[index], memory_order_relaxed);
+}
+
+static void setEntry(blockPalette_t *p, const int index, const block_t block) {
+    atomic_store_explicit(&p->entries[index], (uint8_t)block, memory_order_relaxed);
+}
+
+/**
+ * @brief Gets the narrowest supported width that can index a number of entries
+ * @param size The number of palette entries
+ * @return 0, 1, 2, 4 or 8
+ */
+static int bitsFor(const int size) {
+    if (size <= 1) return 0;
+    if (size <= 2) return 1;
+    if (size <= 4) return 2;
+    if (size <= 16) return 4;
+    return 8;
+}
+
+/**
+ * @brief Repacks every index of a palette at a wider width
+ * @param p A pointer to a palette
+ * @param bits The new number of bits per index
+ * @note Readers see either the old or the new buffer, both complete, so the old one
+ *       goes to the retire callback rather than being freed under them
+ */
+static void widen(blockPalette_t *p, const int bits) {
+    _Atomic uint8_t *old = getData(p);
+    const int oldBits = p->bits;
+    _Atomic uint8_t *data = allocData(bits);
+    for (int i = 0; i < BLOCK_PALETTE_VOLUME; i++) {
+        writeIndex(data, bits, i, readIndex(old, oldBits, i));
+    }
+    atomic_store_explicit(&p->data, data, memory_order_release);
+    p->bits = (uint8_t)bits;
+    count(p, oldBits, false);
+    count(p, bits, true);
+
+    // The uniform placeholder is shared, so there is nothing to retire
+    if (oldBits == 0) return;
+    if (p->retire) {
+        p->retire(p->retireCtx, (void *)old);
+    } else {
+        freeData(old);
+    }
+}
+
+void blockPalette_init(blockPalette_t *p) {
+    p->bits = 0;
+    p->size = 1;
+    atomic_init(&p->entries[0], BL_AIR);
+    atomic_init(&p->data, uniformData + 1);
+    p->retire = NULL;
+    p->retireCtx = NULL;
+    p->stats = NULL;
+}
+
+void blockPalette_initStats(blockPaletteStats_t *s) {
+    atomic_init(&s->bytes, 0);
+    atomic_init(&s->uniform, 0);
+}
+
+void blockPalette_setStats(blockPalette_t *p, blockPaletteStats_t *stats) {
+    if (stats == p->stats) return;
+    count(p, p->bits, false);
+    p->stats = stats;
+    count(p, p->bits, true);
+}
+
+void blockPalette_free(blockPalette_t *p) {
+    count(p, p->bits, false);
+    freeData(getData(p));
+    atomic_store_explicit(&p->data, NULL, memory_order_relaxed);
+}
+
+void blockPalette_fill(blockPalette_t *p, const block_t block) {
+    resetData(p, 0);
+    p->size = 1;
+    setEntry(p, 0, block);
+}
+
+void blockPalette_set(blockPalette_t *p, const int i, const block_t block) {
+    int index = 0;
+    while (index < p->size && getEntry(p, index) != block) {
+        index++;
+    }
+
+    if (index == p->size) {
+        if (p->size == 1 << p->bits) {
+            if (p->bits == 8) {
+                LOG_FATAL("blockPalette has no room for another block type");
+            }
+            // The palette is full, so repack every index at the next width up.
+            // This is also how a uniform palette is materialised on its first edit.
+            widen(p, p->bits == 0 ? 1 : p->bits * 2);
+        }
+        setEntry(p, p->size++, block);
+    }
+
+    if (p->bits > 0) {
+        writeIndex(getData(p), p->bits, i, index);
+    }
+}
+
+void blockPalette_freeRetired(void *ctx, void *data) {
+    (void)ctx;
+    freeData(data);
+}
+
+void blockPalette_pack(blockPalette_t *p, const block_t *blocks) {
+    // Maps each block type to its palette entry, or -1 if it isn't in the palette yet
+    int lookup[BLOCK_PALETTE_MAX_ENTRIES];
+    memset(lookup, -1, sizeof(lookup));
+
+    int size = 0;
+    for (int i = 0; i < BLOCK_PALETTE_VOLUME; i++) {
+        if (lookup[blocks[i]] < 0) {
+            lookup[blocks[i]] = size;
+            setEntry(p, size++, blocks[i]);
+        }
+    }
+
+    resetData(p, bitsFor(size));
+    p->size = (uint16_t)size;
+    if (size == 1) return;
+
+    _Atomic uint8_t *data = getData(p);
+    for (int i = 0; i < BLOCK_PALETTE_VOLUME; i++) {
+        writeIndex(data, p->bits, i, lookup[blocks[i]]);
+    }
+}
+
+void blockPalette_unpack(const blockPalette_t *p, block_t *blocks) {
+    _Atomic uint8_t *data = getData(p);
+    for (int i = 0; i < BLOCK_PALETTE_VOLUME; i++) {
+        blocks[i] = getEntry(p, readIndex(data, p->bits, i));
+    }
+}
+
+bool blockPalette_isUniform(const blockPalette_t *p) {
+    // Reads the width byte rather than bits, so readers on other threads can use it too
+    return atomic_load_explicit(&atomic_load_explicit(&p->data, memory_order_acquire)[-1], memory_order_relaxed) == 0;
+}
+
+size_t blockPalette_bytes(const blockPalette_t *p) {
+    return dataBytes(p->bits);
+}
+
+size_t blockPalette_statsBytes(const blockPaletteStats_t *s) {
+    return atomic_load_explicit(&s->bytes, memory_order_relaxed);
+}
+
+size_t blockPalette_statsUniform(const blockPaletteStats_t *s) {
+    return atomic_load_explicit(&s->uniform, memory_order_relaxed);
+}
@@ -0,0 +1,173 @@
+#ifndef BLOCKPALETTE_H
+#define BLOCKPALETTE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "block.h"
+
+/// The number of blocks held by a palette, one chunk's worth
+#define BLOCK_PALETTE_VOLUME 4096
+/// The most palette entries a palette can hold, at 8 bits per block
+#define BLOCK_PALETTE_MAX_ENTRIES 256
+
+/**
+ * @brief Memory statistics shared by a group of palettes, such as those of a world
+ */
+typedef struct {
+    /// The heap bytes held by the palettes' packed indices
+    atomic_size_t bytes;
+    /// The number of palettes holding a single block type
+    atomic_size_t uniform;
+} blockPaletteStats_t;
+
+/**
+ * @brief Palette-compressed storage for a chunk's blocks
+ * @note Each block is stored as an index into a small per-palette table of block
+ *       types, packed at 1, 2, 4 or 8 bits per block. Since the width always divides
+ *       8, an index never straddles a byte. A palette of a single block type is
+ *       uniform: it uses 0 bits and holds no packed indices at all. The width grows
+ *       on demand when a new block type is written; it only shrinks again when the
+ *       palette is filled or repacked.
+ *
+ *       A single thread writes a palette, but any thread may read it with
+ *       blockPalette_get at the same time. Entries are only ever appended, and a
+ *       writer stores a new entry before the index pointing at it. Widening builds a
+ *       complete new index buffer, publishes it, and hands the old one to the retire
+ *       callback, since a reader may still be walking it. Filling and packing replace
+ *       the contents outright, so they are only used on palettes no reader can reach.
+ */
+typedef struct {
+    /// The number of bits per packed index: 0 (uniform), 1, 2, 4 or 8, only read by the writer
+    uint8_t bits;
+    /// The number of palette entries in use, only read by the writer
+    uint16_t size;
+    /// The block type of each palette entry
+    _Atomic uint8_t entries[BLOCK_PALETTE_MAX_ENTRIES];
+    /// The heap-allocated packed indices, BLOCK_PALETTE_VOLUME * bits / 8 bytes,
+    /// or a shared placeholder when the palette is uniform. The byte before the
+    /// first index holds the width, so readers never need the bits field.
+    _Atomic uint8_t *_Atomic data;
+    /// Takes ownership of an index buffer replaced by a widen, or NULL to free it at once
+    void (*retire)(void *ctx, void *data);
+    /// The context passed to retire
+    void *retireCtx;
+    /// The statistics the palette is counted in, or NULL, only used by the writer
+    blockPaletteStats_t *stats;
+} blockPalette_t;
+
+/**
+ * @brief Initialises a uniform palette of air
+ * @param p A pointer to a palette
+ * @note Replaced index buffers are freed at once until a retire callback is set, and
+ *       the palette isn't counted anywhere until blockPalette_setStats is called
+ */
+void blockPalette_init(blockPalette_t *p);
+
+/**
+ * @brief Initialises memory statistics with nothing counted
+ * @param s A pointer to the statistics
+ */
+void blockPalette_initStats(blockPaletteStats_t *s);
+
+/**
+ * @brief Moves a palette into a set of memory statistics, out of any it was in before
+ * @param p A pointer to a palette
+ * @param stats A pointer to the statistics, or NULL to stop counting the palette
+ */
+void blockPalette_setStats(blockPalette_t *p, blockPaletteStats_t *stats);
+
+/**
+ * @brief Frees a palette's packed indices
+ * @param p A pointer to a palette
+ */
+void blockPalette_free(blockPalette_t *p);
+
+/**
+ * @brief Fills a palette with a single block, making it uniform
+ * @param p A pointer to a palette
+ * @param block The block type
+ */
+void blockPalette_fill(blockPalette_t *p, block_t block);
+
+/**
+ * @brief Gets a block from a palette
+ * @param p A pointer to a palette
+ * @param i The index of the block
+ * @return The block type
+ */
+static inline block_t blockPalette_get(const blockPalette_t *p, const int i) {
+    _Atomic uint8_t *data = atomic_load_explicit(&p->data, memory_order_acquire);
+    const int bits = atomic_load_explicit(&data[-1], memory_order_relaxed);
+    const int bit = i * bits;
+    const int index = (atomic_load_explicit(&data[bit >> 3], memory_order_acquire) >> (bit & 7)) & ((1 << bits) - 1);
+    return (block_t)atomic_load_explicit(&p->entries[index], memory_order_relaxed);
+}
+
+/**
+ * @brief Sets a block in a palette, widening the indices if the palette is full
+ * @param p A pointer to a palette
+ * @param i The index of the block
+ * @param block The block type
+ * @note Writing a new block type into a uniform palette materialises its indices
+ */
+void blockPalette_set(blockPalette_t *p, int i, block_t block);
+
+/**
+ * @brief Frees an index buffer handed to a palette's retire callback
+ * @param ctx Unused, so this can be used as a reclaim callback directly
+ * @param data The index buffer
+ */
+void blockPalette_freeRetired(void *ctx, void *data);
+
+/**
+ * @brief Replaces the contents of a palette with an array of blocks, using the
+ *        narrowest width that fits the distinct block types
+ * @param p A pointer to a palette
+ * @param blocks An array of BLOCK_PALETTE_VOLUME blocks
+ */
+void blockPalette_pack(blockPalette_t *p, const block_t *blocks);
+
+/**
+ * @brief Expands a palette into an array of blocks
+ * @param p A pointer to a palette
+ * @param blocks An array of BLOCK_PALETTE_VOLUME blocks to write to
+ */
+void blockPalette_unpack(const blockPalette_t *p, block_t *blocks);
+
+/**
+ * @brief Checks whether a palette holds a single block type
+ * @param p A pointer to a palette
+ * @return Whether the palette is uniform
+ * @note The block type is then that of entry 0, read with blockPalette_get(p, 0).
+ *       Safe to call while another thread writes the palette.
+ */
+bool blockPalette_isUniform(const blockPalette_t *p);
+
+/**
+ * @brief Gets the heap bytes held by a palette's packed indices
+ * @param p A pointer to a palette
+ * @return The number of bytes
+ */
+size_t blockPalette_bytes(const blockPalette_t *p);
+
+/**
+ * @brief Gets the heap bytes held by the packed indices of the palettes counted in
+ *        a set of statistics
+ * @param s A pointer to the statistics
+ * @return The number of bytes
+ * @note Safe to call from any thread. An index buffer stops counting once its palette
+ *       replaces it, even if it is retired rather than freed at once.
+ */
+size_t blockPalette_statsBytes(const blockPaletteStats_t *s);
+
+/**
+ * @brief Gets the number of uniform palettes counted in a set of statistics
+ * @param s A pointer to the statistics
+ * @return The number of palettes
+ * @note Safe to call from any thread
+ */
+size_t blockPalette_statsUniform(const blockPaletteStats_t *s);
+
+#endif
@@ -8,56 +8,177 @@
 
 #define LIGHT_MAX_VALUE 15
 
-extern bool chunk_createMesh(chunk_t *c, world_t *w);
-extern void chunk_genMesh(chunk_t *c, world_t *w);
+// Saved chunks always store blocks in x, y, z order, whatever the in-memory layout.
+// Gets the index in a saved chunk of the block at a block storage index.
+#define FILE_BLOCK_INDEX(i) ((CHUNK_INDEX_X(i) * CHUNK_SIZE + CHUNK_INDEX_Y(i)) * CHUNK_SIZE + CHUNK_INDEX_Z(i))
 
 static float smoothstep(const float min, const float max, float x) {
     x = glm_clamp((x - min) / (max - min), 0.f, 1.f);
     return x * x * (3.0f - 2.0f * x);
 }
 
-static float getHumidity(const chunk_t *c, const float h, const int x, const int z) {
-    const float n = noise_smoothValue(&c->noise, 0.005f * (float)x - 1024.f, 0.005f * (float)z + 1024.f);
-    return 20.f * n;
+/// The number of block columns in a column of chunks
+#define COLUMN_AREA (CHUNK_SIZE * CHUNK_SIZE)
+/// How far below the surface the cave biome starts
+#define CAVE_DEPTH 5
+
+/// The number of lattice points across a column of chunks sampled with TERRAIN_COARSE,
+/// which includes the first block column of the next chunk along
+#define LATTICE_SIZE (CHUNK_SIZE / TERRAIN_LATTICE_STEP + 1)
+
+/**
+ * @brief Computes humidity offsets
+ * @param noise A pointer to the world's noise
+ * @param xs The block x coordinate of each block column
+ * @param zs The block z coordinate of each block column
+ * @param n The number of block columns, at most COLUMN_AREA
+ * @param out Where to store the offsets
+ */
+static void getHumidity(const noise_t *noise, const float *xs, const float *zs, const int n, float *out) {
+    float nx[COLUMN_AREA];
+    float nz[COLUMN_AREA];
+    for (int i = 0; i < n; i++) {
+        nx[i] = 0.005f * xs[i] - 1024.f;
+        nz[i] = 0.005f * zs[i] + 1024.f;
+    }
+    noise_smoothValueBatch(noise, nx, nz, n, out);
+    for (int i = 0; i < n; i++) {
+        out[i] = 20.f * out[i];
+    }
 }
 
-static float getTemperature(const chunk_t *c, const float h, const int x, const int z) {
-    const float n = noise_smoothValue(&c->noise, 0.003f * (float)x + 1024.f, 0.003f * (float)z - 1024.f);
-    return 15.f * n;
+/**
+ * @brief Computes temperature offsets
+ * @param noise A pointer to the world's noise
+ * @param xs The block x coordinate of each block column
+ * @param zs The block z coordinate of each block column
+ * @param n The number of block columns, at most COLUMN_AREA
+ * @param out Where to store the offsets
+ */
+static void getTemperature(const noise_t *noise, const float *xs, const float *zs, const int n, float *out) {
+    float nx[COLUMN_AREA];
+    float nz[COLUMN_AREA];
+    for (int i = 0; i < n; i++) {
+        nx[i] = 0.003f * xs[i] + 1024.f;
+        nz[i] = 0.003f * zs[i] - 1024.f;
+    }
+    noise_smoothValueBatch(noise, nx, nz, n, out);
+    for (int i = 0; i < n; i++) {
+        out[i] = 15.f * out[i];
+    }
 }
 
-static float getHeight(chunk_t *c, const int x, const int z) {
-    const float xf = (float)x;
-    const float zf = (float)z;
-
-    const float biome = 0.5f + (0.5f * noise_fbm(&c->noise, xf, zf, 2, 0.5f, 0.005f));
-    const float biomeMask = smoothstep(0.4f, 0.8f, biome);
-
-    const float hills = 0.5f + (0.5f * noise_fbm(&c->noise, xf, zf, 5, 0.4f, 0.01f));
+/**
+ * @brief Computes terrain heights, before rounding down to whole blocks
+ * @param noise A pointer to the world's noise
+ * @param xs The block x coordinate of each block column
+ * @param zs The block z coordinate of each block column
+ * @param n The number of block columns, at most COLUMN_AREA
+ * @param out Where to store the heights
+ */
+static void getHeight(noise_t *noise, const float *xs, const float *zs, const int n, float *out) {
+    float biome[COLUMN_AREA];
+    float hills[COLUMN_AREA];
+    float flat[COLUMN_AREA];
+    noise_fbmBatch(noise, xs, zs, n, 2, 0.5f, 0.005f, biome);
+    noise_fbmBatch(noise, xs, zs, n, 5, 0.4f, 0.01f, hills);
+    noise_fbmBatch(noise, xs, zs, n, 3, 0.4f, 0.01f, flat);
+
+    for (int i = 0; i < n; i++) {
+        const float biomeMask = smoothstep(0.4f, 0.8f, 0.5f + (0.5f * biome[i]));
+        const float h = glm_lerp(0.1f + (0.1f * flat[i]), 0.5f + (0.5f * hills[i]), biomeMask);
+        out[i] = h * 50.f;
+    }
+}
 
-    const float flat = 0.1f + (0.1f * noise_fbm(&c->noise, xf, zf, 3, 0.4f, 0.01f));
+/**
+ * @brief Fills in a column of chunks by evaluating the noise at every block column
+ * @param col A pointer to the column, with its coordinates set
+ * @param noise A pointer to the world's noise
+ */
+static void sampleExact(chunkColumn_t *col, noise_t *noise) {
+    float xs[COLUMN_AREA];
+    float zs[COLUMN_AREA];
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            xs[x * CHUNK_SIZE + z] = (float)(col->cx * CHUNK_SIZE + x);
+            zs[x * CHUNK_SIZE + z] = (float)(col->cz * CHUNK_SIZE + z);
+        }
+    }
+    // Each noise is evaluated for the whole column at once, so the batch functions
+    // can work through several block columns per instruction
+    float height[COLUMN_AREA];
+    getHeight(noise, xs, zs, COLUMN_AREA, height);
+    getHumidity(noise, xs, zs, COLUMN_AREA, col->humidityOffset);
+    getTemperature(noise, xs, zs, COLUMN_AREA, col->temperatureOffset);
+    for (int i = 0; i < COLUMN_AREA; i++) {
+        col->height[i] = (int)height[i];
+    }
+}
 
-    const float h = glm_lerp(flat, hills, biomeMask);
+/**
+ * @brief Fills in a column of chunks by evaluating the noise every TERRAIN_LATTICE_STEP
+ *        blocks and interpolating bilinearly in between
+ * @param col A pointer to the column, with its coordinates set
+ * @param noise A pointer to the world's noise
+ * @note The lattice is aligned to world coordinates and takes in the edge of the next
+ *       chunk along, so neighbouring columns agree where they meet.
+ */
+static void sampleCoarse(chunkColumn_t *col, noise_t *noise) {
+    float xs[LATTICE_SIZE * LATTICE_SIZE];
+    float zs[LATTICE_SIZE * LATTICE_SIZE];
+    for (int i = 0; i < LATTICE_SIZE; i++) {
+        for (int j = 0; j < LATTICE_SIZE; j++) {
+            xs[i * LATTICE_SIZE + j] = (float)(col->cx * CHUNK_SIZE + i * TERRAIN_LATTICE_STEP);
+            zs[i * LATTICE_SIZE + j] = (float)(col->cz * CHUNK_SIZE + j * TERRAIN_LATTICE_STEP);
+        }
+    }
+    float height[LATTICE_SIZE * LATTICE_SIZE];
+    float humidity[LATTICE_SIZE * LATTICE_SIZE];
+    float temperature[LATTICE_SIZE * LATTICE_SIZE];
+    getHeight(noise, xs, zs, LATTICE_SIZE * LATTICE_SIZE, height);
+    getHumidity(noise, xs, zs, LATTICE_SIZE * LATTICE_SIZE, humidity);
+    getTemperature(noise, xs, zs, LATTICE_SIZE * LATTICE_SIZE, temperature);
 
-    return h * 50.f;
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        const int i = x / TERRAIN_LATTICE_STEP;
+        const float tx = (float)(x % TERRAIN_LATTICE_STEP) / TERRAIN_LATTICE_STEP;
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            const int j = z / TERRAIN_LATTICE_STEP;
+            const float tz = (float)(z % TERRAIN_LATTICE_STEP) / TERRAIN_LATTICE_STEP;
+            const int l00 = i * LATTICE_SIZE + j;
+            const int l10 = l00 + LATTICE_SIZE;
+            const int b = x * CHUNK_SIZE + z;
+
+            col->height[b] = (int)glm_lerp(glm_lerp(height[l00], height[l10], tx),
+                                           glm_lerp(height[l00 + 1], height[l10 + 1], tx), tz);
+            col->humidityOffset[b] = glm_lerp(glm_lerp(humidity[l00], humidity[l10], tx),
+                                              glm_lerp(humidity[l00 + 1], humidity[l10 + 1], tx), tz);
+            col->temperatureOffset[b] = glm_lerp(glm_lerp(temperature[l00], temperature[l10], tx),
+                                                 glm_lerp(temperature[l00 + 1], temperature[l10 + 1], tx), tz);
+        }
+    }
 }
 
 struct biomeSlice {
     int height;
     float humidityOffset;
     float temperatureOffset;
-
-    int x, z;
 };
 
-static struct biomeSlice createBiomeSlice(chunk_t *c, const int x, const int z) {
-    const float h = getHeight(c, x, z);
+/**
+ * @brief Gets the biome slice of one column of blocks from a column of chunks
+ * @param column A pointer to the column of chunks
+ * @param x Block x within the chunk
+ * @param z Block z within the chunk
+ * @return The slice
+ */
+static struct biomeSlice getBiomeSlice(const chunkColumn_t *column, const int x, const int z) {
+    const int i = x * CHUNK_SIZE + z;
     return (struct biomeSlice) {
-        .height = (int)h,
-        .humidityOffset = getHumidity(c, h, x, z),
-        .temperatureOffset = getTemperature(c, h, x, z),
-        .x = x,
-        .z = z
+        .height = column->height[i],
+        .humidityOffset = column->humidityOffset[i],
+        .temperatureOffset = column->temperatureOffset[i],
     };
 }
 
@@ -65,7 +186,7 @@ static biome_e getBiome(chunk_t *c, const struct biomeSlice bs, const int y) {
     const float humidity = 70.f - 0.6f * (float)y + bs.humidityOffset;
     const float temperature = 30.f - 0.50f * (float)y + bs.temperatureOffset;
 
-    if (bs.height - y > 5) {
+    if (bs.height - y > CAVE_DEPTH) {
         return BIO_CAVE;
     }
     if (temperature > 30.f) {
@@ -93,22 +214,49 @@ void chunk_init(chunk_t *c, const rng_t rng, const noise_t noise, const int cx,
     c->cx = cx;
     c->cy = cy;
     c->cz = cz;
+    memset(c->lightMap, 0, CHUNK_SIZE_CUBED * sizeof(unsigned char));
+    memset(c->neighbours, 0, sizeof(c->neighbours));
+
+    c->vbo = CHUNK_NO_BUFFER;
+    c->vao = CHUNK_NO_BUFFER;
+    c->meshVertices = 0;
+    c->tainted = false;
+    c->generated = false;
+    c->meshLod = 1;
+}
+
+void chunk_poolConstruct(void *obj) {
+    chunk_t *c = obj;
+    blockPalette_init(&c->blocks);
     queue_initQueue(&c->lightTorchInsertionQueue);
     queue_initQueue(&c->lightTorchDeletionQueue);
     queue_initQueue(&c->lightSunInsertionQueue);
     queue_initQueue(&c->lightSunDeletionQueue);
-    memset(c->lightMap, 0, CHUNK_SIZE_CUBED * sizeof(unsigned char));
+}
 
-    c->vbo = -1;
-    c->vao = -1;
+void chunk_poolReuse(void *obj) {
+    chunk_t *c = obj;
+    // Generation only writes solid blocks, and a chunk loaded for lighting can be read
+    // before it is generated, so the blocks must start as air. Everything else is
+    // either set by chunk_init or is a queue whose buffer can be kept.
+    blockPalette_fill(&c->blocks, BL_AIR);
+    queue_clear(&c->lightTorchInsertionQueue);
+    queue_clear(&c->lightTorchDeletionQueue);
+    queue_clear(&c->lightSunInsertionQueue);
+    queue_clear(&c->lightSunDeletionQueue);
 }
 
-void chunk_fill(chunk_t *c, const block_t block) {
-    block_t *ptr = c->blocks;
-    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE; i++) {
-        ptr[i] = block;
-    }
+void chunk_poolDestruct(void *obj) {
+    chunk_t *c = obj;
+    blockPalette_free(&c->blocks);
+    queue_freeQueue(&c->lightTorchInsertionQueue);
+    queue_freeQueue(&c->lightTorchDeletionQueue);
+    queue_freeQueue(&c->lightSunInsertionQueue);
+    queue_freeQueue(&c->lightSunDeletionQueue);
+}
 
+void chunk_fill(chunk_t *c, const block_t block) {
+    blockPalette_fill(&c->blocks, block);
     c->tainted = true;
 }
 
@@ -117,7 +265,14 @@ void chunk_createDeserialise(chunk_t *c, FILE *fp) {
     fread(&c->cy, sizeof(float), 1, fp);
     fread(&c->cz, sizeof(float), 1, fp);
 
-    fread(&c->blocks, sizeof(int), CHUNK_SIZE_CUBED, fp);
+    block_t fileBlocks[CHUNK_SIZE_CUBED];
+    fread(fileBlocks, sizeof(int), CHUNK_SIZE_CUBED, fp);
+
+    block_t blocks[CHUNK_SIZE_CUBED];
+    for (int i = 0; i < CHUNK_SIZE_CUBED; i++) {
+        blocks[i] = fileBlocks[FILE_BLOCK_INDEX(i)];
+    }
+    blockPalette_pack(&c->blocks, blocks);
 
     c->tainted = true;
 }
@@ -126,7 +281,8 @@ void chunk_initSun(chunk_t *c) {
     // return;
     for (int i = 0; i < CHUNK_SIZE; ++i) {
         for (int j = 0; j < CHUNK_SIZE; ++j) {
-            if (c->blocks[i][CHUNK_SIZE - 1][j] == BL_AIR || c->blocks[i][CHUNK_SIZE - 1][j] == BL_LEAF) {
+            const block_t top = chunk_getBlock(c, i, CHUNK_SIZE - 1, j);
+            if (top == BL_AIR || top == BL_LEAF) {
                 lightQueueItem_t nItem = { .pos = { i, CHUNK_SIZE - 1, j }, .lightValue = LIGHT_MAX_VALUE };
                 queue_push(&c->lightSunInsertionQueue, nItem);
             }
@@ -134,14 +290,48 @@ void chunk_initSun(chunk_t *c) {
     }
 }
 
-void chunk_generate(chunk_t *c) {
-    int (*ptr)[CHUNK_SIZE][CHUNK_SIZE] = (int (*)[CHUNK_SIZE][CHUNK_SIZE]) c->blocks;
+void chunk_generateColumn(chunkColumn_t *col,
+                          noise_t *noise,
+                          const int cx,
+                          const int cz,
+                          const terrainSampling_e sampling) {
+    col->cx = cx;
+    col->cz = cz;
+    if (sampling == TERRAIN_COARSE) {
+        sampleCoarse(col, noise);
+    } else {
+        sampleExact(col, noise);
+    }
+
+    col->minHeight = col->height[0];
+    col->maxHeight = col->height[0];
+    for (int i = 1; i < COLUMN_AREA; i++) {
+        col->minHeight = glm_imin(col->minHeight, col->height[i]);
+        col->maxHeight = glm_imax(col->maxHeight, col->height[i]);
+    }
+}
+
+chunkGen_e chunk_generate(chunk_t *c, const chunkColumn_t *column) {
+    const int bottom = c->cy * CHUNK_SIZE;
+    const int top = bottom + CHUNK_SIZE - 1;
+    c->generated = true;
+    // Generation only writes blocks at or below the surface, so above it the chunk stays air
+    if (bottom > column->maxHeight) {
+        c->tainted = true;
+        return GEN_AIR;
+    }
+    // Every block this deep is cave stone, which would overwrite decorations anyway
+    if (column->minHeight - top > CAVE_DEPTH) {
+        chunk_fill(c, BL_STONE);
+        return GEN_STONE;
+    }
+
+    // Generates into a flat array that is packed once at the end
+    block_t ptr[CHUNK_SIZE_CUBED];
+    blockPalette_unpack(&c->blocks, ptr);
     for (int x = 0; x < CHUNK_SIZE; x++) {
         for (int z = 0; z < CHUNK_SIZE; z++) {
-            const int xg = (c->cx * CHUNK_SIZE + x);
-            const int zg = (c->cz * CHUNK_SIZE + z);
-
-            struct biomeSlice bs = createBiomeSlice(c, xg, zg);
+            const struct biomeSlice bs = getBiomeSlice(column, x, z);
 
             for (int y = 0; y < CHUNK_SIZE; y++) {
                 const int yg = c->cy * CHUNK_SIZE + y;
@@ -152,28 +342,28 @@ void chunk_generate(chunk_t *c) {
                     switch (b) {
                         case BIO_NIL: {
                             LOG_WARN("Unknown biome");
-                            ptr[x][y][z] = BL_STONE;
+                            ptr[CHUNK_BLOCK_INDEX(x, y, z)] = BL_STONE;
                             break;
                         }
                         case BIO_PLAINS:
                         case BIO_FOREST: {
-                            ptr[x][y][z] = ds == 0 ? BL_GRASS : BL_DIRT;
+                            ptr[CHUNK_BLOCK_INDEX(x, y, z)] = ds == 0 ? BL_GRASS : BL_DIRT;
                             break;
                         }
                         case BIO_JUNGLE: {
-                            ptr[x][y][z] = ds == 0 ? BL_JUNGLE_GRASS : BL_MUD;
+                            ptr[CHUNK_BLOCK_INDEX(x, y, z)] = ds == 0 ? BL_JUNGLE_GRASS : BL_MUD;
                             break;
                         }
                         case BIO_DESERT: {
-                            ptr[x][y][z] = BL_SAND;
+                            ptr[CHUNK_BLOCK_INDEX(x, y, z)] = BL_SAND;
                             break;
                         }
                         case BIO_TUNDRA: {
-                            ptr[x][y][z] = BL_SNOW;
+                            ptr[CHUNK_BLOCK_INDEX(x, y, z)] = BL_SNOW;
                             break;
                         }
                         case BIO_CAVE: {
-                            ptr[x][y][z] = BL_STONE;
+                            ptr[CHUNK_BLOCK_INDEX(x, y, z)] = BL_STONE;
                             break;
                         }
                     }
@@ -184,27 +374,14 @@ void chunk_generate(chunk_t *c) {
             }
         }
     }
+    blockPalette_pack(&c->blocks, ptr);
 
     c->tainted = true;
-}
-
-void chunk_checkMesh(chunk_t *c, world_t *w) {
-    if (c->tainted) {
-        if (chunk_createMesh(c, w)) {
-            c->tainted = false;
-        }
-    }
-}
-
-void chunk_checkGenMesh(chunk_t *c, world_t *w) {
-    if (c->tainted && !c->verticesValid) {
-        chunk_genMesh(c, w);
-        c->verticesValid = true;
-    }
+    return GEN_FULL;
 }
 
 void chunk_draw(const chunk_t *c, const int modelLocation) {
-    if (c->vbo == -1) { return; }
+    if (c->vbo == CHUNK_NO_BUFFER) { return; }
     mat4 model;
     vec3 cPos = { (float)c->cx * CHUNK_SIZE, (float)c->cy * CHUNK_SIZE, (float)c->cz * CHUNK_SIZE };
     glm_translate_make(model, cPos);
@@ -222,18 +399,16 @@ typedef struct {
 } MainThreadFrees_t;
 
 void chunk_free(chunk_t *c, spscRing_t *freeQueue) {
-    MainThreadFrees_t *toFree = malloc(sizeof(MainThreadFrees_t));
-    toFree->vbo = c->vbo;
-    toFree->vao = c->vao;
-    spscRing_offer(freeQueue, toFree);
-
-    if (c->verticesValid) {
-        free(c->vertices);
+    // A chunk that was never uploaded has no buffers to delete
+    if (c->vbo != CHUNK_NO_BUFFER) {
+        MainThreadFrees_t *toFree = malloc(sizeof(MainThreadFrees_t));
+        toFree->vbo = c->vbo;
+        toFree->vao = c->vao;
+        spscRing_offer(freeQueue, toFree);
     }
-    queue_freeQueue(&c->lightTorchInsertionQueue);
-    queue_freeQueue(&c->lightTorchDeletionQueue);
-    queue_freeQueue(&c->lightSunInsertionQueue);
-    queue_freeQueue(&c->lightSunDeletionQueue);
+
+    // Chunks waiting in the pool shouldn't hold on to packed blocks
+    blockPalette_fill(&c->blocks, BL_AIR);
 }
 
 
@@ -251,5 +426,12 @@ void chunk_serialise(const chunk_t *c, FILE *fp) {
     fwrite(&c->cy, sizeof(int), 1, fp);
     fwrite(&c->cz, sizeof(int), 1, fp);
 
-    fwrite(&c->blocks, sizeof(int), CHUNK_SIZE_CUBED, fp);
+    block_t blocks[CHUNK_SIZE_CUBED];
+    blockPalette_unpack(&c->blocks, blocks);
+
+    block_t fileBlocks[CHUNK_SIZE_CUBED];
+    for (int i = 0; i < CHUNK_SIZE_CUBED; i++) {
+        fileBlocks[FILE_BLOCK_INDEX(i)] = blocks[i];
+    }
+    fwrite(fileBlocks, sizeof(int), CHUNK_SIZE_CUBED, fp);
 }
@@ -2,10 +2,12 @@
 #define CHUNK_H
 
 #include <glad/gl.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 
 #include "block.h"
+#include "blockpalette.h"
 #include "queue.h"
 #include "noise.h"
 #include "spscqueue.h"
@@ -13,6 +15,8 @@
 
 #define CHUNK_SIZE 16
 #define CHUNK_SIZE_CUBED 4096
+/// The vbo and vao of a chunk that has no buffers yet
+#define CHUNK_NO_BUFFER ((GLuint)-1)
 
 typedef struct world_t world_t;
 
@@ -29,16 +33,110 @@ typedef enum {
     BIO_JUNGLE,
 } biome_e;
 
+/**
+ * @brief Gets the index into a chunk's neighbour table for a chunk offset.
+ * @param dx The x offset, from -1 to 1
+ * @param dy The y offset, from -1 to 1
+ * @param dz The z offset, from -1 to 1
+ */
+#define CHUNK_NEIGHBOUR_INDEX(dx, dy, dz) (((dx) + 1) * 9 + ((dy) + 1) * 3 + ((dz) + 1))
+
+/**
+ * @brief Gets a fully loaded neighbour of a chunk, or NULL if it isn't loaded.
+ * @param c A pointer to a chunk
+ * @param dx The x offset, from -1 to 1
+ * @param dy The y offset, from -1 to 1
+ * @param dz The z offset, from -1 to 1
+ */
+#define chunk_neighbour(c, dx, dy, dz) ((c)->neighbours[CHUNK_NEIGHBOUR_INDEX(dx, dy, dz)])
+
+#ifdef CHUNK_MORTON_LAYOUT
+/**
+ * @brief Spreads the 4 bits of a chunk coordinate out to every third bit.
+ * @param v The coordinate, from 0 to 15
+ */
+#define CHUNK_MORTON_SPREAD(v) (((v) & 1) | (((v) & 2) << 2) | (((v) & 4) << 4) | (((v) & 8) << 6))
+
+/**
+ * @brief Gathers every third bit of a Morton index back into a chunk coordinate.
+ * @param i The Morton index shifted so the coordinate's lowest bit is bit 0
+ */
+#define CHUNK_MORTON_GATHER(i) (((i) & 1) | (((i) >> 2) & 2) | (((i) >> 4) & 4) | (((i) >> 6) & 8))
+
+/**
+ * @brief Gets the index of a block within a chunk's block storage and light map.
+ * @param x The x coordinate within the chunk
+ * @param y The y coordinate within the chunk
+ * @param z The z coordinate within the chunk
+ * @note Built with CHUNK_MORTON_LAYOUT, the bits of x, y and z are interleaved, so each
+ *       2x2x2 cell is contiguous and neighbours on every axis are usually close together.
+ */
+#define CHUNK_BLOCK_INDEX(x, y, z) \
+    ((CHUNK_MORTON_SPREAD(x) << 2) | (CHUNK_MORTON_SPREAD(y) << 1) | CHUNK_MORTON_SPREAD(z))
+
+/// Gets the x, y and z coordinates within the chunk of a block storage index
+#define CHUNK_INDEX_X(i) CHUNK_MORTON_GATHER((i) >> 2)
+#define CHUNK_INDEX_Y(i) CHUNK_MORTON_GATHER((i) >> 1)
+#define CHUNK_INDEX_Z(i) CHUNK_MORTON_GATHER(i)
+#else
+/**
+ * @brief Gets the index of a block within a chunk's block storage and light map.
+ * @param x The x coordinate within the chunk
+ * @param y The y coordinate within the chunk
+ * @param z The z coordinate within the chunk
+ */
+#define CHUNK_BLOCK_INDEX(x, y, z) (((x) * CHUNK_SIZE + (y)) * CHUNK_SIZE + (z))
+
+/// Gets the x, y and z coordinates within the chunk of a block storage index
+#define CHUNK_INDEX_X(i) ((i) >> 8)
+#define CHUNK_INDEX_Y(i) (((i) >> 4) & (CHUNK_SIZE - 1))
+#define CHUNK_INDEX_Z(i) ((i) & (CHUNK_SIZE - 1))
+#endif
+
+/**
+ * @brief Gets a light map entry of a chunk, as an lvalue.
+ * @param c A pointer to a chunk
+ * @param x The x coordinate within the chunk
+ * @param y The y coordinate within the chunk
+ * @param z The z coordinate within the chunk
+ */
+#define chunk_light(c, x, y, z) ((c)->lightMap[CHUNK_BLOCK_INDEX(x, y, z)])
+
+/**
+ * @brief Gets a block from a chunk.
+ * @param c A pointer to a chunk
+ * @param x The x coordinate within the chunk
+ * @param y The y coordinate within the chunk
+ * @param z The z coordinate within the chunk
+ */
+#define chunk_getBlock(c, x, y, z) blockPalette_get(&(c)->blocks, CHUNK_BLOCK_INDEX(x, y, z))
+
+/**
+ * @brief Sets a block in a chunk.
+ * @param c A pointer to a chunk
+ * @param x The x coordinate within the chunk
+ * @param y The y coordinate within the chunk
+ * @param z The z coordinate within the chunk
+ * @param block The block type
+ */
+#define chunk_setBlock(c, x, y, z, block) blockPalette_set(&(c)->blocks, CHUNK_BLOCK_INDEX(x, y, z), block)
+
+/**
+ * @brief Checks whether every block in a chunk is the same type.
+ * @param c A pointer to a chunk
+ */
+#define chunk_isUniform(c) blockPalette_isUniform(&(c)->blocks)
+
 /**
  * @brief A struct containing data about a chunk.
  */
-typedef struct {
+typedef struct chunk_t {
     /// Chunk coordinates.
     int cx, cy, cz;
-    /// The array of blocks in the chunk.
-    block_t blocks[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE];
-    /// The array of light levels in the chunk.
-    unsigned char lightMap[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE];
+    /// The palette-compressed blocks in the chunk, accessed with chunk_getBlock and chunk_setBlock.
+    blockPalette_t blocks;
+    /// The array of light levels in the chunk, in block storage order and accessed with chunk_light.
+    unsigned char lightMap[CHUNK_SIZE_CUBED];
     /// The queue of light values used for adding lights to the lightMap
     lightQueue_t lightTorchInsertionQueue;
     lightQueue_t lightSunInsertionQueue;
@@ -49,13 +147,14 @@ typedef struct {
     GLuint vbo;
     /// The VAO that is used for drawing.
     GLuint vao;
-    /// Number of vertices in the current mesh
+    /// Number of vertices in the uploaded mesh, only used by the render thread
     int meshVertices;
-    /// Holds whether the mesh needs to be regenerated.
+    /// Holds whether the mesh needs to be regenerated, only used by the chunk loading thread
     bool tainted;
-
-    vertex_t *vertices;
-    bool verticesValid;
+    /// Whether chunk_generate has filled in the terrain
+    bool generated;
+    /// The level of detail of the latest mesh, only used by the chunk loading thread
+    int meshLod;
 
     /// A rng for use in terrain generation
     rng_t rng;
@@ -63,8 +162,61 @@ typedef struct {
     noise_t noise;
     /// The biome of the chunk
     biome_e biome;
+
+    /// The 26 fully loaded neighbours and the chunk itself, NULL where not loaded
+    /// @note Only maintained once the chunk itself is fully loaded
+    struct chunk_t *neighbours[27];
 } chunk_t;
 
+/// The spacing in blocks of the lattice TERRAIN_COARSE samples the noise on, which divides CHUNK_SIZE
+#define TERRAIN_LATTICE_STEP 4
+
+/**
+ * @brief How the terrain noise is sampled across a column of chunks
+ */
+typedef enum {
+    /// The noise is evaluated at every block column
+    TERRAIN_EXACT,
+    /// The noise is evaluated every TERRAIN_LATTICE_STEP blocks and interpolated in between,
+    /// which is much cheaper but smooths out detail smaller than the lattice
+    TERRAIN_COARSE,
+} terrainSampling_e;
+
+/**
+ * @brief The terrain height and biome offsets of every column of blocks in a column of chunks
+ * @note Only depends on the world's noise and the column's coordinates, so it is
+ *       computed once and shared by every chunk stacked in the column.
+ */
+typedef struct {
+    /// The chunk x coordinate of the column
+    int cx;
+    /// The chunk z coordinate of the column
+    int cz;
+    /// The height of the surface, indexed by x * CHUNK_SIZE + z
+    int height[CHUNK_SIZE * CHUNK_SIZE];
+    /// The humidity offset, indexed like height
+    float humidityOffset[CHUNK_SIZE * CHUNK_SIZE];
+    /// The temperature offset, indexed like height
+    float temperatureOffset[CHUNK_SIZE * CHUNK_SIZE];
+    /// The lowest height in the column
+    int minHeight;
+    /// The highest height in the column
+    int maxHeight;
+} chunkColumn_t;
+
+/**
+ * @brief How chunk_generate filled a chunk
+ */
+typedef enum {
+    /// Every block was generated from the column
+    GEN_FULL,
+    /// The chunk is above the surface of every block column, so nothing was generated
+    GEN_AIR,
+    /// The chunk is deep enough below the surface of every block column to be all cave
+    /// stone, so it was filled with stone without generating each block
+    GEN_STONE,
+} chunkGen_e;
+
 /**
  * @brief Initialises a chunk
  * @param c A pointer to a chunk
@@ -76,6 +228,25 @@ typedef struct {
  */
 void chunk_init(chunk_t *c, rng_t rng, noise_t noise, int cx, int cy, int cz);
 
+/**
+ * @brief Allocates a chunk's block storage and light queues, used as the chunk pool's construct callback
+ * @param obj A pointer to a freshly allocated, zeroed chunk
+ */
+void chunk_poolConstruct(void *obj);
+
+/**
+ * @brief Clears the parts of a recycled chunk that chunk_init doesn't overwrite,
+ *        used as the chunk pool's reuse callback
+ * @param obj A pointer to a chunk
+ */
+void chunk_poolReuse(void *obj);
+
+/**
+ * @brief Frees a chunk's block storage and light queues, used as the chunk pool's destruct callback
+ * @param obj A pointer to a chunk
+ */
+void chunk_poolDestruct(void *obj);
+
 /**
  * @brief Fills a chunk with a certain block
  * @param c A pointer to a chunk
@@ -98,25 +269,23 @@ void chunk_createDeserialise(chunk_t *c, FILE *fp);
 void chunk_initSun(chunk_t *c);
 
 /**
- * @brief A function to generate a chunk
- * @param c A pointer to a chunk
- * @note The chunk object should be empty/uninitialised.
- */
-void chunk_generate(chunk_t *c);
-
-/**
- * @brief Remeshes the chunk if necessary
- * @param c A pointer to a chunk
- * @param w A pointer to a world
+ * @brief Computes the terrain height and biome offsets of a column of chunks
+ * @param col A pointer to the column to fill in
+ * @param noise A pointer to the world's noise, which is only read
+ * @param cx The chunk x coordinate
+ * @param cz The chunk z coordinate
+ * @param sampling How to sample the noise
  */
-void chunk_checkMesh(chunk_t *c, world_t *w);
+void chunk_generateColumn(chunkColumn_t *col, noise_t *noise, int cx, int cz, terrainSampling_e sampling);
 
 /**
- * @brief Checks if a mesh is invalid, and if so generates one.
+ * @brief A function to generate a chunk
  * @param c A pointer to a chunk
- * @param w A pointer to a world
+ * @param column A pointer to the chunk's column, computed by chunk_generateColumn
+ * @return How the chunk was filled
+ * @note The chunk object should be empty/uninitialised.
  */
-void chunk_checkGenMesh(chunk_t *c, world_t *w);
+chunkGen_e chunk_generate(chunk_t *c, const chunkColumn_t *column);
 
 /**
  * @brief Draws a chunk.
@@ -126,9 +295,10 @@ void chunk_checkGenMesh(chunk_t *c, world_t *w);
 void chunk_draw(const chunk_t *c, int modelLocation);
 
 /**
-* @brief A function for freeing a chunk
+* @brief A function for freeing a chunk's GPU buffers and mesh, and emptying its blocks
 * @param c A pointer to a chunk
 * @param freeQueue A queue of VBOs to free
+* @note The chunk's memory itself belongs to the world's chunk pool
 */
 void chunk_free(chunk_t *c, spscRing_t *freeQueue);
 
@@ -3,52 +3,97 @@
 #include <stdlib.h>
 #include <string.h>
 #include "chunk.h"
+#include "chunkmesh.h"
 #include "lighting.h"
 #include "vertices.h"
 #include "GLFW/glfw3.h"
 
+/// Which neighbour a coordinate in a grid size cells across falls in, as an index into meshInput_t::present
+#define NEIGHBOUR_SLOT(v, size) ((v) < 0 ? 0 : (v) >= (size) ? 2 : 1)
+
+/**
+ * @brief Checks whether a cell of a mesh input was captured
+ * @param in A pointer to a mesh input
+ * @param x Cell x, from -1 to in->size
+ * @param y Cell y, from -1 to in->size
+ * @param z Cell z, from -1 to in->size
+ * @return Whether the chunk the cell is in was loaded
+ */
+static bool inputHasBlock(const meshInput_t *in, const int x, const int y, const int z) {
+    return in->present[NEIGHBOUR_SLOT(x, in->size)][NEIGHBOUR_SLOT(y, in->size)][NEIGHBOUR_SLOT(z, in->size)];
+}
+
 /**
  * @brief Checks if a block's face neighbours air or the chunk edge
- * @param w A pointer to a world
- * @param c A pointer to a chunk
+ * @param in A pointer to a mesh input
  * @param blockPos The position of the block to check
  * @param dir The face of the block to check
  * @return If the face is visible
  */
-static bool faceIsVisible(world_t *w, const chunk_t *c, ivec3 blockPos, const direction_e dir) {
-    ivec3 dirVec;
-    memcpy(&dirVec, &directions[dir], sizeof(ivec3));
+static bool faceIsVisible(const meshInput_t *in, ivec3 blockPos, const direction_e dir) {
     ivec3 neighbourPos;
-    glm_ivec3_add(blockPos, dirVec, neighbourPos);
-    ivec3 chunkOffset = { 0, 0, 0 };
-    for (int i = 0; i < 3; i++) {
-        if (neighbourPos[i] < 0) {
-            neighbourPos[i] = CHUNK_SIZE - 1;
-            chunkOffset[i] = -1;
-        } else if (neighbourPos[i] >= CHUNK_SIZE) {
-            neighbourPos[i] = 0;
-            chunkOffset[i] = 1;
-        }
+    glm_ivec3_add(blockPos, directions[dir], neighbourPos);
+    if (!inputHasBlock(in, neighbourPos[0], neighbourPos[1], neighbourPos[2])) {
+        return true;
+    }
+    const bool crossesSeam = (in->seams & (1 << dir)) &&
+                             (neighbourPos[0] < 0 || neighbourPos[0] >= in->size ||
+                              neighbourPos[1] < 0 || neighbourPos[1] >= in->size ||
+                              neighbourPos[2] < 0 || neighbourPos[2] >= in->size);
+    if (crossesSeam) {
+        return true;
     }
-    if (chunkOffset[0] == 0 && chunkOffset[1] == 0 && chunkOffset[2] == 0) {
-        block_t type = c->blocks[neighbourPos[0]][neighbourPos[1]][neighbourPos[2]];
-        return BL_TRANSPARENT(type);
-    } else {
-        ivec3 cPos = { c->cx, c->cy, c->cz };
-        glm_ivec3_add(cPos, chunkOffset, cPos);
-        chunk_t *nChunk = world_getFullyLoadedChunk(w, cPos[0], cPos[1], cPos[2]);
-        if (!nChunk) {
-            return true;
+    return BL_TRANSPARENT(in->blocks[MESH_INPUT_INDEX(in->size, neighbourPos[0], neighbourPos[1], neighbourPos[2])]);
+}
+
+/**
+ * @brief Computes the light value of a vertex by averaging the light of the 4 cells
+ *        touching it on the side the face points to
+ * @param in A pointer to a mesh input
+ * @param vx Vertex x in cells
+ * @param vy Vertex y in cells
+ * @param vz Vertex z in cells
+ * @param dir The direction the face points in
+ * @return The light value from 0 to 1
+ */
+static float vertexLight(const meshInput_t *in, const int vx, const int vy, const int vz, const direction_e dir) {
+    // The cells on the face's side sit one back along a negative normal, and the
+    // other two axes take the blocks on both sides of the vertex
+    int normalAxis = 0;
+    while (directions[dir][normalAxis] == 0) {
+        normalAxis++;
+    }
+    const int v[3] = { vx, vy, vz };
+
+    int count = 0;
+    int sum = 0;
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            int pos[3];
+            int side = 0;
+            for (int axis = 0; axis < 3; axis++) {
+                if (axis == normalAxis) {
+                    pos[axis] = v[axis] + (directions[dir][axis] < 0 ? -1 : 0);
+                } else {
+                    pos[axis] = v[axis] - (side++ == 0 ? i : j);
+                }
+            }
+            if (!inputHasBlock(in, pos[0], pos[1], pos[2])) continue;
+            const int lv = in->light[MESH_INPUT_INDEX(in->size, pos[0], pos[1], pos[2])];
+            sum += glm_imax(EXTRACT_TORCH(lv), EXTRACT_SUN(lv));
+            count++;
         }
-        block_t type = nChunk->blocks[neighbourPos[0]][neighbourPos[1]][neighbourPos[2]];
-        return BL_TRANSPARENT(type);
     }
+
+    if (count == 0) {
+        return 0.0f;
+    }
+    return ((float)sum / (float)count) / (float)LIGHT_MAX_VALUE;
 }
 
 /**
  * @brief Writes vertices of a face specified by buf
- * @param w A pointer to a world
- * @param c A pointer to a chunk
+ * @param in A pointer to a mesh input
  * @param buf A buffer of vertices
  * @param blockPos The position of the block
  * @param dir The face of the block
@@ -57,8 +102,7 @@ static bool faceIsVisible(world_t *w, const chunk_t *c, ivec3 blockPos, const di
  * @param type The type of block
  * @return Pointer to next free position in buffer
  */
-static vertex_t *writeFace(world_t *w,
-                            chunk_t *c,
+static vertex_t *writeFace(const meshInput_t *in,
                             vertex_t *buf,
                             const ivec3 blockPos,
                             const direction_e dir,
@@ -77,7 +121,7 @@ static vertex_t *writeFace(world_t *w,
                 buf[i].y = buf[i].y * (float)height + (float)blockPos[1];
                 buf[i].z += (float)blockPos[2];
                 buf[i].texIndex += texIndex;
-                buf[i].lightValue = computeVertexLight(w, c, (int)buf[i].x, (int)buf[i].y, (int)buf[i].z, dir);
+                buf[i].lightValue = vertexLight(in, (int)buf[i].x, (int)buf[i].y, (int)buf[i].z, dir);
             }
             break;
         case DIR_PLUSY:
@@ -87,7 +131,7 @@ static vertex_t *writeFace(world_t *w,
                 buf[i].y += (float)blockPos[1];
                 buf[i].z = buf[i].z * (float)height + (float)blockPos[2];
                 buf[i].texIndex += texIndex;
-                buf[i].lightValue = computeVertexLight(w, c, (int)buf[i].x, (int)buf[i].y, (int)buf[i].z, dir);
+                buf[i].lightValue = vertexLight(in, (int)buf[i].x, (int)buf[i].y, (int)buf[i].z, dir);
             }
             break;
         case DIR_PLUSX:
@@ -97,10 +141,16 @@ static vertex_t *writeFace(world_t *w,
                 buf[i].y = buf[i].y * (float)width + (float)blockPos[1];
                 buf[i].z = buf[i].z * (float)height + (float)blockPos[2];
                 buf[i].texIndex += texIndex;
-                buf[i].lightValue = computeVertexLight(w, c, (int)buf[i].x, (int)buf[i].y, (int)buf[i].z, dir);
+                buf[i].lightValue = vertexLight(in, (int)buf[i].x, (int)buf[i].y, (int)buf[i].z, dir);
             }
             break;
     }
+    // Faces are built in cells, which are lod blocks across
+    for (int i = 0; i < 6; ++i) {
+        buf[i].x *= (float)in->lod;
+        buf[i].y *= (float)in->lod;
+        buf[i].z *= (float)in->lod;
+    }
     return buf + 6;
 }
 
@@ -148,130 +198,301 @@ static void getNextCoord(ivec3 out,
 
 /**
  * @brief Greedy meshes in one direction, writing quads to buf
- * @param world A pointer to a world
- * @param c A pointer to a chunk
+ * @param in A pointer to a mesh input
  * @param dir The direction to mesh in
  * @param buf A buffer of vertices
  * @return The updated pointer to the buffer
  */
-static vertex_t *greedyMeshDirection(world_t *world, chunk_t *c, const direction_e dir, vertex_t *buf) {
+static vertex_t *greedyMeshDirection(const meshInput_t *in, const direction_e dir, vertex_t *buf) {
     ivec3 dirVec;
     memcpy(&dirVec, &directions[dir], sizeof(ivec3));
     vertex_t *nextPtr = buf;
     bool seen[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE] = {0};
-    for (int i = 0; i < CHUNK_SIZE; ++i) {
-        for (int j = 0; j < CHUNK_SIZE; ++j) {
-            for (int k = 0; k < CHUNK_SIZE; ++k) {
-                ivec3 base = {i, j, k};
-                const block_t type = c->blocks[i][j][k];
-                if (seen[i][j][k] || type == BL_AIR || !faceIsVisible(world, c, base, dir)) {
-                    continue;
-                }
-                seen[i][j][k] = true;
-                unsigned char light = glm_imax(EXTRACT_SUN(c->lightMap[i][j][k]), EXTRACT_TORCH(c->lightMap[i][j][k]));
-                int width = 1;
-                int height = 1;
+    const int size = in->size;
+    // Walks the cells in the input's x, y, z order, so the block and light reads are sequential
+    for (int idx = 0; idx < size * size * size; ++idx) {
+        const int i = idx / (size * size);
+        const int j = idx / size % size;
+        const int k = idx % size;
+        ivec3 base = {i, j, k};
+        const block_t type = in->blocks[MESH_INPUT_INDEX(size, i, j, k)];
+        if (seen[i][j][k] || type == BL_AIR || !faceIsVisible(in, base, dir)) {
+            continue;
+        }
+        seen[i][j][k] = true;
+        unsigned char light = glm_imax(EXTRACT_SUN(in->light[MESH_INPUT_INDEX(size, i, j, k)]),
+                                       EXTRACT_TORCH(in->light[MESH_INPUT_INDEX(size, i, j, k)]));
+        int width = 1;
+        int height = 1;
 
-                // removed greedy meshing due to vertex lighting making merged faces look strange
+        // removed greedy meshing due to vertex lighting making merged faces look strange
 
-            //     // expand width
-            //     for (; width < CHUNK_SIZE; ++width) {
-            //         ivec3 nextCoord;
-            //         getNextCoord(nextCoord, i, j, k, dir, width, 0);
-            //         ivec3 normalNextCoord;
-            //         glm_ivec3_add(nextCoord, dirVec, normalNextCoord);
-            //         int nx = nextCoord[0], ny = nextCoord[1], nz = nextCoord[2];
-            //         if (nx < 0 || ny < 0 || nz < 0 || nx >= CHUNK_SIZE || ny >= CHUNK_SIZE || nz >= CHUNK_SIZE) {
-            //             break;
-            //         }
-            //         if (normalNextCoord[0] >= 0 && normalNextCoord[1] >= 0 && normalNextCoord[2] >= 0 &&
-            //             normalNextCoord[0] < CHUNK_SIZE && normalNextCoord[1] < CHUNK_SIZE && normalNextCoord[2] < CHUNK_SIZE) {
-            //             if (light != glm_imax(EXTRACT_SUN(c->lightMap[normalNextCoord[0]][normalNextCoord[1]][normalNextCoord[2]]),
-            //                 EXTRACT_TORCH(c->lightMap[normalNextCoord[0]][normalNextCoord[1]][normalNextCoord[2]]))) {
-            //                 break;
-            //             }
-            //         }
-            //         if (seen[nx][ny][nz] || c->blocks[nx][ny][nz] != type || !faceIsVisible(world, c, nextCoord, dir)) {
-            //             break;
-            //         }
-            //         seen[nx][ny][nz] = true;
-            //     }
-            //     // expand height
-            //     bool ok;
-            //     for (; height < CHUNK_SIZE; ++height) {
-            //         ok = true;
-            //         for (int w = 0; w < width; ++w) {
-            //             ivec3 nextCoord;
-            //             getNextCoord(nextCoord, i, j, k, dir, w, height);
-            //             ivec3 normalNextCoord;
-            //             glm_ivec3_add(nextCoord, dirVec, normalNextCoord);
-            //             int nx = nextCoord[0], ny = nextCoord[1], nz = nextCoord[2];
-            //             if (nx < 0 || ny < 0 || nz < 0 || nx >= CHUNK_SIZE || ny >= CHUNK_SIZE || nz >= CHUNK_SIZE) {
-            //                 ok = false;
-            //                 break;
-            //             }
-            //             if (normalNextCoord[0] >= 0 && normalNextCoord[1] >= 0 && normalNextCoord[2] >= 0 &&
-            //                 normalNextCoord[0] < CHUNK_SIZE && normalNextCoord[1] < CHUNK_SIZE && normalNextCoord[2] < CHUNK_SIZE) {
-            //                 if (light != glm_imax(EXTRACT_SUN(c->lightMap[normalNextCoord[0]][normalNextCoord[1]][normalNextCoord[2]]),
-            //                 EXTRACT_TORCH(c->lightMap[normalNextCoord[0]][normalNextCoord[1]][normalNextCoord[2]]))) {
-            //                     ok = false;
-            //                     break;
-            //                 }
-            //             }
-            //             if (seen[nx][ny][nz] || c->blocks[nx][ny][nz] != type || !faceIsVisible(world, c, nextCoord, dir)) {
-            //                 ok = false;
-            //                 break;
-            //             }
-            //         }
-            //         if (!ok) {
-            //             break;
-            //         }
-            //         for (int w = 0; w < width; ++w) {
-            //             ivec3 nextCoord;
-            //             getNextCoord(nextCoord, i, j, k, dir, w, height);
-            //             int nx = nextCoord[0], ny = nextCoord[1], nz = nextCoord[2];
-            //             seen[nx][ny][nz] = true;
-            //         }
-            //     }
-                nextPtr = writeFace(world, c, nextPtr, base, dir, width, height, type);
-            }
-        }
+    //     // expand width
+    //     for (; width < CHUNK_SIZE; ++width) {
+    //         ivec3 nextCoord;
+    //         getNextCoord(nextCoord, i, j, k, dir, width, 0);
+    //         ivec3 normalNextCoord;
+    //         glm_ivec3_add(nextCoord, dirVec, normalNextCoord);
+    //         int nx = nextCoord[0], ny = nextCoord[1], nz = nextCoord[2];
+    //         if (nx < 0 || ny < 0 || nz < 0 || nx >= CHUNK_SIZE || ny >= CHUNK_SIZE || nz >= CHUNK_SIZE) {
+    //             break;
+    //         }
+    //         if (normalNextCoord[0] >= 0 && normalNextCoord[1] >= 0 && normalNextCoord[2] >= 0 &&
+    //             normalNextCoord[0] < CHUNK_SIZE && normalNextCoord[1] < CHUNK_SIZE && normalNextCoord[2] < CHUNK_SIZE) {
+    //             if (light != glm_imax(EXTRACT_SUN(chunk_light(c, normalNextCoord[0], normalNextCoord[1], normalNextCoord[2])),
+    //                 EXTRACT_TORCH(chunk_light(c, normalNextCoord[0], normalNextCoord[1], normalNextCoord[2])))) {
+    //                 break;
+    //             }
+    //         }
+    //         if (seen[nx][ny][nz] || c->blocks[nx][ny][nz] != type || !faceIsVisible(world, c, nextCoord, dir)) {
+    //             break;
+    //         }
+    //         seen[nx][ny][nz] = true;
+    //     }
+    //     // expand height
+    //     bool ok;
+    //     for (; height < CHUNK_SIZE; ++height) {
+    //         ok = true;
+    //         for (int w = 0; w < width; ++w) {
+    //             ivec3 nextCoord;
+    //             getNextCoord(nextCoord, i, j, k, dir, w, height);
+    //             ivec3 normalNextCoord;
+    //             glm_ivec3_add(nextCoord, dirVec, normalNextCoord);
+    //             int nx = nextCoord[0], ny = nextCoord[1], nz = nextCoord[2];
+    //             if (nx < 0 || ny < 0 || nz < 0 || nx >= CHUNK_SIZE || ny >= CHUNK_SIZE || nz >= CHUNK_SIZE) {
+    //                 ok = false;
+    //                 break;
+    //             }
+    //             if (normalNextCoord[0] >= 0 && normalNextCoord[1] >= 0 && normalNextCoord[2] >= 0 &&
+    //                 normalNextCoord[0] < CHUNK_SIZE && normalNextCoord[1] < CHUNK_SIZE && normalNextCoord[2] < CHUNK_SIZE) {
+    //                 if (light != glm_imax(EXTRACT_SUN(chunk_light(c, normalNextCoord[0], normalNextCoord[1], normalNextCoord[2])),
+    //                 EXTRACT_TORCH(chunk_light(c, normalNextCoord[0], normalNextCoord[1], normalNextCoord[2])))) {
+    //                     ok = false;
+    //                     break;
+    //                 }
+    //             }
+    //             if (seen[nx][ny][nz] || c->blocks[nx][ny][nz] != type || !faceIsVisible(world, c, nextCoord, dir)) {
+    //                 ok = false;
+    //                 break;
+    //             }
+    //         }
+    //         if (!ok) {
+    //             break;
+    //         }
+    //         for (int w = 0; w < width; ++w) {
+    //             ivec3 nextCoord;
+    //             getNextCoord(nextCoord, i, j, k, dir, w, height);
+    //             int nx = nextCoord[0], ny = nextCoord[1], nz = nextCoord[2];
+    //             seen[nx][ny][nz] = true;
+    //         }
+    //     }
+        nextPtr = writeFace(in, nextPtr, base, dir, width, height, type);
     }
     return nextPtr;
 }
 
 /**
- * @brief Generates a mesh for a chunk
+ * @brief Checks if a chunk can't have any visible faces, which is when it is all
+ *        air, or all one opaque block and enclosed by loaded neighbours that are too
  * @param c A pointer to a chunk
- * @param w A pointer to a world
+ * @return If the chunk has no visible faces
  */
-void chunk_genMesh(chunk_t *c, world_t *w) {
-    const size_t bytesPerBlock = sizeof(vertex_t) * 36;
-    c->vertices = malloc(CHUNK_SIZE_CUBED * bytesPerBlock);
-    vertex_t *nextPtr = c->vertices;
+static bool hasNoFaces(const chunk_t *c) {
+    if (!chunk_isUniform(c)) {
+        return false;
+    }
+    const block_t type = blockPalette_get(&c->blocks, 0);
+    if (type == BL_AIR) {
+        return true;
+    }
+    if (BL_TRANSPARENT(type)) {
+        return false;
+    }
     for (direction_e dir = 0; dir < 6; ++dir) {
-        nextPtr = greedyMeshDirection(w, c, dir, nextPtr);
+        const chunk_t *nChunk = chunk_neighbour(c, directions[dir][0], directions[dir][1], directions[dir][2]);
+        if (!nChunk || !chunk_isUniform(nChunk)) {
+            return false;
+        }
+        const block_t nType = blockPalette_get(&nChunk->blocks, 0);
+        if (BL_TRANSPARENT(nType)) {
+            return false;
+        }
     }
-    const GLsizeiptr sizeToWrite = (GLsizeiptr)sizeof(vertex_t) * (nextPtr - c->vertices);
-    c->meshVertices = (int)sizeToWrite / (int)sizeof(vertex_t);
+    return true;
 }
 
 /**
- * @brief Writes the mesh generated by chunk_genMesh to opengl
- * @param c A pointer to a chunk
- * @param w A pointer to a world
+ * @brief Downsamples a cube of blocks into one cell of a mesh input below full detail
+ * @param in A pointer to the mesh input
+ * @param c A pointer to the chunk being captured
+ * @param blocks The chunk's own blocks, unpacked in storage order
+ * @param x Cell x, from -1 to in->size
+ * @param y Cell y, from -1 to in->size
+ * @param z Cell z, from -1 to in->size
  */
-bool chunk_createMesh(chunk_t *c, world_t *w) {
-    if (!c->verticesValid) return false;
+static void captureCell(meshInput_t *in, const chunk_t *c, const block_t *blocks, const int x, const int y, const int z) {
+    const int sx = NEIGHBOUR_SLOT(x, in->size);
+    const int sy = NEIGHBOUR_SLOT(y, in->size);
+    const int sz = NEIGHBOUR_SLOT(z, in->size);
+    if (!in->present[sx][sy][sz]) return;
+    const chunk_t *n = sx == 1 && sy == 1 && sz == 1 ? c : chunk_neighbour(c, sx - 1, sy - 1, sz - 1);
+
+    const int lod = in->lod;
+    // The cube's corner in the chunk it lies in
+    const int bx = (x + in->size) % in->size * lod;
+    const int by = (y + in->size) % in->size * lod;
+    const int bz = (z + in->size) % in->size * lod;
+
+    block_t top = BL_AIR;
+    int solid = 0;
+    int torch = 0;
+    int sun = 0;
+    // Top down, so the cell takes the block on the surface, such as grass over dirt
+    for (int dy = lod - 1; dy >= 0; dy--) {
+        for (int dx = 0; dx < lod; dx++) {
+            for (int dz = 0; dz < lod; dz++) {
+                block_t type;
+                if (n == c) {
+                    type = blocks[CHUNK_BLOCK_INDEX(bx + dx, by + dy, bz + dz)];
+                } else {
+                    type = chunk_getBlock(n, bx + dx, by + dy, bz + dz);
+                }
+                const unsigned char lv = chunk_light(n, bx + dx, by + dy, bz + dz);
+                torch = glm_imax(torch, EXTRACT_TORCH(lv));
+                sun = glm_imax(sun, EXTRACT_SUN(lv));
+                if (type == BL_AIR) continue;
+                if (top == BL_AIR) {
+                    top = type;
+                }
+                solid++;
+            }
+        }
+    }
+
+    in->blocks[MESH_INPUT_INDEX(in->size, x, y, z)] = solid * 2 >= lod * lod * lod ? top : BL_AIR;
+    in->light[MESH_INPUT_INDEX(in->size, x, y, z)] = (unsigned char)(sun << 4 | torch);
+}
+
+void chunkMesh_capture(meshInput_t *in, chunk_t *c, const int lod, const unsigned char seams) {
+    in->chunk = c;
+    in->cx = c->cx;
+    in->cy = c->cy;
+    in->cz = c->cz;
+    in->lod = lod;
+    in->size = CHUNK_SIZE / lod;
+    in->seams = seams;
+    in->noFaces = hasNoFaces(c);
+    if (in->noFaces) return;
+
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dz = -1; dz <= 1; dz++) {
+                in->present[dx + 1][dy + 1][dz + 1] = chunk_neighbour(c, dx, dy, dz) != NULL;
+            }
+        }
+    }
+
+    // The chunk itself is unpacked in one go
+    block_t blocks[CHUNK_SIZE_CUBED];
+    blockPalette_unpack(&c->blocks, blocks);
+
+    if (lod > 1) {
+        for (int x = -1; x <= in->size; x++) {
+            for (int y = -1; y <= in->size; y++) {
+                for (int z = -1; z <= in->size; z++) {
+                    captureCell(in, c, blocks, x, y, z);
+                }
+            }
+        }
+        return;
+    }
+
+    // At full detail the chunk is scattered from storage order
+    for (int idx = 0; idx < CHUNK_SIZE_CUBED; idx++) {
+        const int x = CHUNK_INDEX_X(idx);
+        const int y = CHUNK_INDEX_Y(idx);
+        const int z = CHUNK_INDEX_Z(idx);
+        in->blocks[MESH_INPUT_INDEX(CHUNK_SIZE, x, y, z)] = blocks[idx];
+        in->light[MESH_INPUT_INDEX(CHUNK_SIZE, x, y, z)] = c->lightMap[idx];
+    }
+
+    // Only the one block border is read from the neighbours
+    for (int x = -1; x <= CHUNK_SIZE; x++) {
+        for (int y = -1; y <= CHUNK_SIZE; y++) {
+            for (int z = -1; z <= CHUNK_SIZE; z++) {
+                const int sx = NEIGHBOUR_SLOT(x, CHUNK_SIZE);
+                const int sy = NEIGHBOUR_SLOT(y, CHUNK_SIZE);
+                const int sz = NEIGHBOUR_SLOT(z, CHUNK_SIZE);
+                if (sx == 1 && sy == 1 && sz == 1) {
+                    // Skips straight over the inside of the chunk
+                    z = CHUNK_SIZE - 1;
+                    continue;
+                }
+                if (!in->present[sx][sy][sz]) continue;
+                const chunk_t *n = chunk_neighbour(c, sx - 1, sy - 1, sz - 1);
+                const int nx = (x + CHUNK_SIZE) % CHUNK_SIZE;
+                const int ny = (y + CHUNK_SIZE) % CHUNK_SIZE;
+                const int nz = (z + CHUNK_SIZE) % CHUNK_SIZE;
+                in->blocks[MESH_INPUT_INDEX(CHUNK_SIZE, x, y, z)] = chunk_getBlock(n, nx, ny, nz);
+                in->light[MESH_INPUT_INDEX(CHUNK_SIZE, x, y, z)] = chunk_light(n, nx, ny, nz);
+            }
+        }
+    }
+}
+
+chunkMesh_t *chunkMesh_build(const meshInput_t *in) {
+    chunkMesh_t *m = malloc(sizeof(chunkMesh_t));
+    if (!m) {
+        LOG_FATAL("chunkMesh allocation failed");
+    }
+    m->chunk = in->chunk;
+    m->cx = in->cx;
+    m->cy = in->cy;
+    m->cz = in->cz;
+    m->sequence = 0;
+    m->vertices = NULL;
+    m->nVertices = 0;
+    if (in->noFaces) return m;
+
+    const size_t bytesPerBlock = sizeof(vertex_t) * 36;
+    vertex_t *vertices = malloc((size_t)(in->size * in->size * in->size) * bytesPerBlock);
+    if (!vertices) {
+        LOG_FATAL("chunkMesh allocation failed");
+    }
+    vertex_t *nextPtr = vertices;
+    for (direction_e dir = 0; dir < 6; ++dir) {
+        nextPtr = greedyMeshDirection(in, dir, nextPtr);
+    }
+    m->nVertices = (int)(nextPtr - vertices);
+    if (m->nVertices == 0) {
+        free(vertices);
+        return m;
+    }
+    // The mesh may wait in the queue for a while, so it only keeps what it uses
+    m->vertices = realloc(vertices, m->nVertices * sizeof(vertex_t));
+    if (!m->vertices) {
+        m->vertices = vertices;
+    }
+    return m;
+}
 
-    if (c->vbo == -1) {
+void chunkMesh_upload(chunk_t *c, const chunkMesh_t *m, world_t *w) {
+    // A chunk that has never had any faces doesn't need any buffers
+    if (m->nVertices == 0 && c->vbo == CHUNK_NO_BUFFER) return;
+
+    atomic_fetch_add_explicit(&w->meshBytes, (size_t)m->nVertices * sizeof(vertex_t), memory_order_relaxed);
+    atomic_fetch_sub_explicit(&w->meshBytes, (size_t)c->meshVertices * sizeof(vertex_t), memory_order_relaxed);
+    c->meshVertices = m->nVertices;
+
+    #ifndef WORLD_HEADLESS
+    if (c->vbo == CHUNK_NO_BUFFER) {
         glGenBuffers(1, &c->vbo);
         glBindBuffer(GL_ARRAY_BUFFER, c->vbo);
         glGenVertexArrays(1, &c->vao);
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, c->vbo);
-    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(c->meshVertices * sizeof(vertex_t)), c->vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(c->meshVertices * sizeof(vertex_t)), m->vertices, GL_STATIC_DRAW);
 
     glBindVertexArray(c->vao);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *) 0);
@@ -283,8 +504,10 @@ bool chunk_createMesh(chunk_t *c, world_t *w) {
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+    #endif
+}
 
-    c->verticesValid = false;
-    free(c->vertices);
-    return true;
-}
\ No newline at end of file
+void chunkMesh_free(chunkMesh_t *m) {
+    free(m->vertices);
+    free(m);
+}
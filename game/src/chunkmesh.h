@@ -0,0 +1,100 @@
+#ifndef CHUNKMESH_H
+#define CHUNKMESH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "chunk.h"
+#include "vertices.h"
+
+/// The widest a mesh input gets, a full detail chunk plus a one block border taken from its neighbours
+#define MESH_INPUT_SIZE (CHUNK_SIZE + 2)
+/// The index of a cell in a mesh input size cells across, from coordinates that may be -1 or size
+#define MESH_INPUT_INDEX(size, x, y, z) \
+    ((((x) + 1) * ((size) + 2) + ((y) + 1)) * ((size) + 2) + ((z) + 1))
+
+/// The coarsest level of detail, the most blocks across one cell of a mesh
+#define MAX_MESH_LOD 4
+
+/**
+ * @brief A copy of everything meshing a chunk reads, which is its blocks and light
+ *        levels and those of a one cell border around it
+ * @note Captured by the chunk loading thread, so mesh jobs never read live chunks.
+ *       Below full detail, each cell stands for a cube of lod blocks: it takes the
+ *       top block of the cube if at least half the cube is solid and is air
+ *       otherwise, and the brightest light in the cube. Border cells are
+ *       downsampled from whole cubes of the neighbours too, so two neighbouring
+ *       chunks at the same level of detail agree on the cells either side of
+ *       their shared face.
+ */
+typedef struct {
+    /// The chunk the input was captured from, never dereferenced by chunkMesh_build
+    chunk_t *chunk;
+    /// The chunk's coordinates
+    int cx, cy, cz;
+    /// Whether the chunk can't have any visible faces, in which case nothing below is filled in
+    bool noFaces;
+    /// The level of detail, the number of blocks across one cell: 1, 2 or MAX_MESH_LOD
+    int lod;
+    /// The number of cells across the chunk, CHUNK_SIZE / lod
+    int size;
+    /// Bit 1 << dir is set where the neighbour across that face is meshed at another level
+    /// of detail, and faces towards it are never culled so no cracks open along the seam
+    unsigned char seams;
+    /// Which neighbours were loaded, indexed by offset + 1, the chunk itself in the middle
+    bool present[3][3][3];
+    /// The cells, indexed with MESH_INPUT_INDEX and left unset where a neighbour is missing
+    block_t blocks[MESH_INPUT_SIZE * MESH_INPUT_SIZE * MESH_INPUT_SIZE];
+    /// The light levels, indexed like blocks
+    unsigned char light[MESH_INPUT_SIZE * MESH_INPUT_SIZE * MESH_INPUT_SIZE];
+} meshInput_t;
+
+/**
+ * @brief An immutable chunk mesh, built from a mesh input and handed to the render thread
+ */
+typedef struct {
+    /// The chunk the mesh is for, only dereferenced once found in the render thread's snapshot
+    chunk_t *chunk;
+    /// The chunk's coordinates
+    int cx, cy, cz;
+    /// The sequence number of the first snapshot that holds the chunk
+    uint64_t sequence;
+    /// The heap-allocated vertices, NULL if there are none
+    vertex_t *vertices;
+    /// The number of vertices
+    int nVertices;
+} chunkMesh_t;
+
+/**
+ * @brief Copies what meshing a chunk needs out of it and its neighbours
+ * @param in A pointer to the input to fill in
+ * @param c A pointer to a fully loaded chunk
+ * @param lod The level of detail: 1 for full detail, 2 or MAX_MESH_LOD
+ * @param seams The faces towards neighbours at another level of detail, bit 1 << dir for each
+ * @note Called from the chunk loading thread
+ */
+void chunkMesh_capture(meshInput_t *in, chunk_t *c, int lod, unsigned char seams);
+
+/**
+ * @brief Builds a chunk's mesh from a captured input
+ * @param in A pointer to the input
+ * @return A pointer to the heap-allocated mesh
+ * @note Only reads the input, so it can run on any thread
+ */
+chunkMesh_t *chunkMesh_build(const meshInput_t *in);
+
+/**
+ * @brief Uploads a mesh to a chunk's GPU buffers, replacing the mesh drawn until now
+ * @param c A pointer to the chunk the mesh is for
+ * @param m A pointer to the mesh
+ * @param w A pointer to a world
+ * @note Called from the render thread
+ */
+void chunkMesh_upload(chunk_t *c, const chunkMesh_t *m, world_t *w);
+
+/**
+ * @brief Frees a mesh
+ * @param m A pointer to the mesh
+ */
+void chunkMesh_free(chunkMesh_t *m);
+
+#endif
@@ -0,0 +1,65 @@
+#include <logging.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "chunksnapshot.h"
+
+/**
+ * @brief Hashes integer chunk coordinates
+ * @return The hash
+ */
+static uint32_t hashCoords(const int cx, const int cy, const int cz) {
+    uint32_t h = (uint32_t)cx * 0x8DA6B343u ^ (uint32_t)cy * 0xD8163841u ^ (uint32_t)cz * 0xCB1AB31Fu;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    return h ^ (h >> 15);
+}
+
+chunkSnapshot_t *chunkSnapshot_create(const size_t capacity) {
+    // Keep the table at most half full so probe runs stay short
+    size_t nSlots = 16;
+    while (nSlots < capacity * 2) {
+        nSlots <<= 1;
+    }
+
+    chunkSnapshot_t *s = malloc(sizeof(chunkSnapshot_t));
+    if (!s) {
+        LOG_FATAL("chunkSnapshot allocation failed");
+    }
+    s->count = 0;
+    s->sequence = 0;
+    s->chunks = malloc((capacity ? capacity : 1) * sizeof(chunk_t *));
+    s->mask = nSlots - 1;
+    s->slots = calloc(nSlots, sizeof(chunk_t *));
+    if (!s->chunks || !s->slots) {
+        LOG_FATAL("chunkSnapshot allocation failed");
+    }
+    return s;
+}
+
+void chunkSnapshot_add(chunkSnapshot_t *s, chunk_t *c) {
+    size_t i = hashCoords(c->cx, c->cy, c->cz) & s->mask;
+    while (s->slots[i]) {
+        i = (i + 1) & s->mask;
+    }
+    s->slots[i] = c;
+    s->chunks[s->count++] = c;
+}
+
+chunk_t *chunkSnapshot_get(const chunkSnapshot_t *s, const int cx, const int cy, const int cz) {
+    size_t i = hashCoords(cx, cy, cz) & s->mask;
+    chunk_t *c;
+    while ((c = s->slots[i])) {
+        if (c->cx == cx && c->cy == cy && c->cz == cz) {
+            return c;
+        }
+        i = (i + 1) & s->mask;
+    }
+    return NULL;
+}
+
+void chunkSnapshot_free(chunkSnapshot_t *s) {
+    if (!s) return;
+    free(s->chunks);
+    free(s->slots);
+    free(s);
+}
@@ -0,0 +1,60 @@
+#ifndef CHUNKSNAPSHOT_H
+#define CHUNKSNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chunk.h"
+
+/**
+ * @brief An immutable set of the fully loaded chunks, published to the render thread
+ * @note The chunk loading thread builds a new snapshot whenever a chunk becomes fully
+ *       loaded or is unloaded, publishes it, and retires the old one. Since a snapshot
+ *       is never modified once published, the render thread can look chunks up and
+ *       iterate them without locking. Lookups use linear probing over a power-of-two
+ *       table of chunk pointers keyed on the chunks' own coordinates.
+ */
+typedef struct {
+    /// The number of chunks in the snapshot
+    size_t count;
+    /// The heap-allocated dense array of chunks
+    chunk_t **chunks;
+    /// The number of slots minus one (the number of slots is a power of two)
+    size_t mask;
+    /// The heap-allocated slot array, NULL where a slot is free
+    chunk_t **slots;
+    /// Incremented for every snapshot published, so later snapshots have larger numbers
+    uint64_t sequence;
+} chunkSnapshot_t;
+
+/**
+ * @brief Creates an empty snapshot
+ * @param capacity The most chunks that will be added
+ * @return A pointer to the snapshot
+ */
+chunkSnapshot_t *chunkSnapshot_create(size_t capacity);
+
+/**
+ * @brief Adds a chunk to a snapshot that hasn't been published yet
+ * @param s A pointer to a snapshot
+ * @param c A pointer to the chunk, which must not already be present
+ */
+void chunkSnapshot_add(chunkSnapshot_t *s, chunk_t *c);
+
+/**
+ * @brief Looks up a chunk in a snapshot
+ * @param s A pointer to a snapshot
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ * @return A pointer to the chunk, or NULL if it isn't present
+ */
+chunk_t *chunkSnapshot_get(const chunkSnapshot_t *s, int cx, int cy, int cz);
+
+/**
+ * @brief Frees a snapshot
+ * @param s A pointer to a snapshot, may be NULL
+ * @note Does not free the chunks themselves
+ */
+void chunkSnapshot_free(chunkSnapshot_t *s);
+
+#endif
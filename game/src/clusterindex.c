@@ -0,0 +1,166 @@
+#include <logging.h>
+#include <stdlib.h>
+#include "clusterindex.h"
+
+/**
+ * @brief The per-thread cache of the last successful lookup
+ */
+static _Thread_local struct {
+    const clusterIndex_t *index;
+    unsigned int generation;
+    clusterKey_t key;
+    void *value;
+} lastHit;
+
+/// Seeds each index's generation so a reused address can't match a stale cache entry
+static atomic_uint initSerial;
+
+/**
+ * @brief Hashes integer cluster coordinates
+ * @param k The key
+ * @return The hash
+ */
+static uint32_t hashKey(const clusterKey_t k) {
+    uint32_t h = (uint32_t)k.x * 0x8DA6B343u ^ (uint32_t)k.y * 0xD8163841u ^ (uint32_t)k.z * 0xCB1AB31Fu;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    return h ^ (h >> 15);
+}
+
+static bool keyEquals(const clusterKey_t a, const clusterKey_t b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+/**
+ * @brief Finds the slot holding a key
+ * @param ci A pointer to a cluster index
+ * @param key The key
+ * @return The slot index, or the index of the empty slot that ended the probe
+ */
+static size_t findSlot(const clusterIndex_t *ci, const clusterKey_t key) {
+    size_t i = hashKey(key) & ci->mask;
+    while (ci->slots[i].dense != CLUSTER_INDEX_EMPTY && !keyEquals(ci->slots[i].key, key)) {
+        i = (i + 1) & ci->mask;
+    }
+    return i;
+}
+
+static void allocSlots(clusterIndex_t *ci, const size_t nSlots) {
+    ci->slots = malloc(nSlots * sizeof(clusterSlot_t));
+    if (!ci->slots) {
+        LOG_FATAL("clusterIndex slot allocation failed");
+    }
+    for (size_t i = 0; i < nSlots; i++) {
+        ci->slots[i].dense = CLUSTER_INDEX_EMPTY;
+    }
+    ci->mask = nSlots - 1;
+}
+
+/**
+ * @brief Doubles the slot array and reinserts every key
+ * @param ci A pointer to a cluster index
+ */
+static void growSlots(clusterIndex_t *ci) {
+    clusterSlot_t *old = ci->slots;
+    allocSlots(ci, 2 * (ci->mask + 1));
+    for (size_t d = 0; d < ci->count; d++) {
+        const size_t i = findSlot(ci, ci->keys[d]);
+        ci->slots[i].key = ci->keys[d];
+        ci->slots[i].dense = (uint32_t)d;
+    }
+    free(old);
+}
+
+void clusterIndex_init(clusterIndex_t *ci, size_t capacity) {
+    if (capacity < 8) capacity = 8;
+
+    // Keep the load factor at or below a half
+    size_t nSlots = 16;
+    while (nSlots < 2 * capacity) nSlots <<= 1;
+    allocSlots(ci, nSlots);
+
+    ci->values = malloc(capacity * sizeof(void *));
+    ci->keys = malloc(capacity * sizeof(clusterKey_t));
+    if (!ci->values || !ci->keys) {
+        LOG_FATAL("clusterIndex allocation failed");
+    }
+    ci->count = 0;
+    ci->capacity = capacity;
+    atomic_init(&ci->generation, atomic_fetch_add(&initSerial, 1u << 20));
+}
+
+void *clusterIndex_get(const clusterIndex_t *ci, const clusterKey_t key) {
+    const unsigned int generation = atomic_load_explicit(&ci->generation, memory_order_acquire);
+    if (lastHit.index == ci && lastHit.generation == generation && keyEquals(lastHit.key, key)) {
+        return lastHit.value;
+    }
+
+    const clusterSlot_t slot = ci->slots[findSlot(ci, key)];
+    if (slot.dense == CLUSTER_INDEX_EMPTY) return NULL;
+
+    lastHit.index = ci;
+    lastHit.generation = generation;
+    lastHit.key = key;
+    lastHit.value = ci->values[slot.dense];
+    return lastHit.value;
+}
+
+void clusterIndex_insert(clusterIndex_t *ci, const clusterKey_t key, void *value) {
+    if (2 * (ci->count + 1) > ci->mask + 1) {
+        growSlots(ci);
+    }
+    if (ci->count == ci->capacity) {
+        ci->capacity *= 2;
+        ci->values = realloc(ci->values, ci->capacity * sizeof(void *));
+        ci->keys = realloc(ci->keys, ci->capacity * sizeof(clusterKey_t));
+        if (!ci->values || !ci->keys) {
+            LOG_FATAL("clusterIndex resize failed");
+        }
+    }
+
+    const size_t i = findSlot(ci, key);
+    ci->slots[i].key = key;
+    ci->slots[i].dense = (uint32_t)ci->count;
+    ci->values[ci->count] = value;
+    ci->keys[ci->count] = key;
+    ci->count++;
+}
+
+bool clusterIndex_remove(clusterIndex_t *ci, const clusterKey_t key) {
+    size_t i = findSlot(ci, key);
+    const uint32_t d = ci->slots[i].dense;
+    if (d == CLUSTER_INDEX_EMPTY) return false;
+
+    atomic_fetch_add_explicit(&ci->generation, 1, memory_order_release);
+
+    // Backward-shift deletion: pull later entries of the probe run into the hole
+    // whenever their home slot doesn't lie cyclically between the hole and themselves
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & ci->mask;
+        if (ci->slots[j].dense == CLUSTER_INDEX_EMPTY) break;
+        const size_t home = hashKey(ci->slots[j].key) & ci->mask;
+        if (((j - home) & ci->mask) >= ((j - i) & ci->mask)) {
+            ci->slots[i] = ci->slots[j];
+            i = j;
+        }
+    }
+    ci->slots[i].dense = CLUSTER_INDEX_EMPTY;
+
+    // Move the last dense value into the removed value's place
+    const size_t last = ci->count - 1;
+    if (d != last) {
+        ci->values[d] = ci->values[last];
+        ci->keys[d] = ci->keys[last];
+        ci->slots[findSlot(ci, ci->keys[d])].dense = d;
+    }
+    ci->count--;
+
+    return true;
+}
+
+void clusterIndex_free(const clusterIndex_t *ci) {
+    free(ci->slots);
+    free(ci->values);
+    free(ci->keys);
+}
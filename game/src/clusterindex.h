@@ -0,0 +1,92 @@
+#ifndef CLUSTERINDEX_H
+#define CLUSTERINDEX_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CLUSTER_INDEX_EMPTY UINT32_MAX
+
+/**
+ * @brief Key for the cluster index, in cluster coordinates
+ */
+typedef struct {
+    int x, y, z;
+} clusterKey_t;
+
+/**
+ * @brief A single slot of the open-addressing table
+ */
+typedef struct {
+    /// The key stored in this slot
+    clusterKey_t key;
+    /// The index into the dense arrays, or CLUSTER_INDEX_EMPTY if the slot is free
+    uint32_t dense;
+} clusterSlot_t;
+
+/**
+ * @brief An open-addressing hash table from cluster coordinates to clusters
+ * @note Uses linear probing over a power-of-two table with backward-shift deletion,
+ *       so no tombstones are ever left behind. Values are also kept in a dense array
+ *       so the loaded clusters can be iterated without walking empty slots.
+ */
+typedef struct {
+    /// The heap-allocated slot array
+    clusterSlot_t *slots;
+    /// The number of slots minus one (the number of slots is a power of two)
+    size_t mask;
+    /// The heap-allocated dense array of values
+    void **values;
+    /// The keys of the values in the dense array
+    clusterKey_t *keys;
+    /// The number of values in the index
+    size_t count;
+    /// The capacity of the dense arrays
+    size_t capacity;
+    /// Incremented on every removal, used to invalidate the per-thread lookup cache
+    atomic_uint generation;
+} clusterIndex_t;
+
+/**
+ * @brief Initialises a cluster index
+ * @param ci A pointer to a cluster index
+ * @param capacity The number of values to reserve space for
+ */
+void clusterIndex_init(clusterIndex_t *ci, size_t capacity);
+
+/**
+ * @brief Looks up a value in the cluster index
+ * @param ci A pointer to a cluster index
+ * @param key The key to look up
+ * @return The value, or NULL if the key isn't present
+ * @note The last hit is cached per thread, so repeated lookups of the same cluster skip hashing
+ */
+void *clusterIndex_get(const clusterIndex_t *ci, clusterKey_t key);
+
+/**
+ * @brief Inserts a value into the cluster index
+ * @param ci A pointer to a cluster index
+ * @param key The key, which must not already be present
+ * @param value The value
+ */
+void clusterIndex_insert(clusterIndex_t *ci, clusterKey_t key, void *value);
+
+/**
+ * @brief Removes a value from the cluster index
+ * @param ci A pointer to a cluster index
+ * @param key The key to remove
+ * @return Whether the key was present
+ * @note The last value in the dense array is moved into the removed value's place, so
+ *       callers removing while iterating should iterate from the back.
+ */
+bool clusterIndex_remove(clusterIndex_t *ci, clusterKey_t key);
+
+/**
+ * @brief Frees a cluster index
+ * @param ci A pointer to a cluster index
+ * @note Does not free the values themselves
+ */
+void clusterIndex_free(const clusterIndex_t *ci);
+
+#endif
@@ -0,0 +1,108 @@
+#include <logging.h>
+#include <stdlib.h>
+#include "columncache.h"
+
+/// The number of columns to reserve space for, enough for a full view distance across
+#define COLUMN_CACHE_CAPACITY 4096
+/// The number of evicted columns kept for reuse
+#define COLUMN_POOL_HIGH_WATER 512
+
+void columnCache_init(columnCache_t *cc, noise_t *noise) {
+    clusterIndex_init(&cc->index, COLUMN_CACHE_CAPACITY);
+    pool_init(&cc->pool, sizeof(chunkColumn_t), COLUMN_POOL_HIGH_WATER, NULL, NULL, NULL);
+    cc->pending.items = NULL;
+    cc->pending.n = 0;
+    cc->pending.capacity = 0;
+    cc->noise = noise;
+    cc->sampling = TERRAIN_EXACT;
+}
+
+static bool keepNone(void *ctx, const int cx, const int cz) {
+    (void)ctx;
+    (void)cx;
+    (void)cz;
+    return false;
+}
+
+void columnCache_setSampling(columnCache_t *cc, const terrainSampling_e sampling) {
+    if (sampling == cc->sampling) return;
+    columnCache_evict(cc, keepNone, NULL);
+    cc->sampling = sampling;
+}
+
+/**
+ * @brief Adds an uncomputed column to the cache
+ * @param cc A pointer to a column cache
+ * @param cx The chunk x coordinate
+ * @param cz The chunk z coordinate
+ * @return A pointer to the column
+ */
+static chunkColumn_t *insertColumn(columnCache_t *cc, const int cx, const int cz) {
+    chunkColumn_t *col = pool_acquire(&cc->pool);
+    col->cx = cx;
+    col->cz = cz;
+    clusterIndex_insert(&cc->index, (clusterKey_t){ cx, 0, cz }, col);
+    return col;
+}
+
+void columnCache_request(columnCache_t *cc, const int cx, const int cz) {
+    if (clusterIndex_get(&cc->index, (clusterKey_t){ cx, 0, cz })) return;
+
+    if (cc->pending.n == cc->pending.capacity) {
+        const size_t capacity = cc->pending.capacity ? cc->pending.capacity * 2 : 64;
+        chunkColumn_t **items = realloc(cc->pending.items, capacity * sizeof(chunkColumn_t *));
+        if (!items) {
+            LOG_FATAL("Pending columns realloc failed");
+        }
+        cc->pending.items = items;
+        cc->pending.capacity = capacity;
+    }
+    cc->pending.items[cc->pending.n++] = insertColumn(cc, cx, cz);
+}
+
+static void columnJob(void *ctx, void *item) {
+    const columnCache_t *cc = ctx;
+    chunkColumn_t *col = item;
+    chunk_generateColumn(col, cc->noise, col->cx, col->cz, cc->sampling);
+}
+
+void columnCache_generatePending(columnCache_t *cc, jobPool_t *jobs) {
+    jobPool_run(jobs, columnJob, cc, (void **)cc->pending.items, cc->pending.n);
+    cc->pending.n = 0;
+}
+
+const chunkColumn_t *columnCache_get(const columnCache_t *cc, const int cx, const int cz) {
+    return clusterIndex_get(&cc->index, (clusterKey_t){ cx, 0, cz });
+}
+
+const chunkColumn_t *columnCache_acquire(columnCache_t *cc, const int cx, const int cz) {
+    const chunkColumn_t *col = columnCache_get(cc, cx, cz);
+    if (col) return col;
+
+    chunkColumn_t *fresh = insertColumn(cc, cx, cz);
+    chunk_generateColumn(fresh, cc->noise, cx, cz, cc->sampling);
+    return fresh;
+}
+
+void columnCache_evict(columnCache_t *cc, const columnCache_keep_t keep, void *ctx) {
+    // Removal moves the last column into the removed one's place, so iterate from the back
+    for (size_t i = cc->index.count; i-- > 0;) {
+        chunkColumn_t *col = cc->index.values[i];
+        if (keep(ctx, col->cx, col->cz)) continue;
+        clusterIndex_remove(&cc->index, cc->index.keys[i]);
+        pool_release(&cc->pool, col);
+    }
+}
+
+size_t columnCache_count(const columnCache_t *cc) {
+    return cc->index.count;
+}
+
+void columnCache_free(columnCache_t *cc) {
+    for (size_t i = 0; i < cc->index.count; i++) {
+        pool_release(&cc->pool, cc->index.values[i]);
+    }
+    clusterIndex_free(&cc->index);
+    pool_free(&cc->pool);
+    free(cc->pending.items);
+}
@@ -0,0 +1,116 @@
+#ifndef COLUMNCACHE_H
+#define COLUMNCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "chunk.h"
+#include "clusterindex.h"
+#include "jobpool.h"
+#include "noise.h"
+#include "pool.h"
+
+/**
+ * @brief Decides whether a cached column is still wanted
+ * @param ctx The context given to columnCache_evict
+ * @param cx The column's chunk x coordinate
+ * @param cz The column's chunk z coordinate
+ * @return Whether to keep the column
+ */
+typedef bool (*columnCache_keep_t)(void *ctx, int cx, int cz);
+
+/**
+ * @brief A cache of the terrain columns shared by vertically stacked chunks
+ * @note Owned by the chunk loading thread. Columns are requested before a parallel
+ *       generation batch and computed in parallel by columnCache_generatePending, so
+ *       while the batch runs the cache is only read and needs no locking.
+ */
+typedef struct {
+    /// The columns, keyed by { cx, 0, cz }
+    clusterIndex_t index;
+    /// The pool of chunkColumn_t objects
+    pool_t pool;
+    /// The columns requested since the last columnCache_generatePending
+    struct {
+        chunkColumn_t **items;
+        size_t n;
+        size_t capacity;
+    } pending;
+    /// The noise the columns are computed from
+    noise_t *noise;
+    /// How the noise is sampled, TERRAIN_EXACT until columnCache_setSampling is called
+    terrainSampling_e sampling;
+} columnCache_t;
+
+/**
+ * @brief Initialises a column cache
+ * @param cc A pointer to a column cache
+ * @param noise A pointer to the world's noise, which must outlive the cache
+ */
+void columnCache_init(columnCache_t *cc, noise_t *noise);
+
+/**
+ * @brief Sets how the terrain noise is sampled, dropping every cached column if it changes
+ * @param cc A pointer to a column cache
+ * @param sampling How to sample the noise
+ * @note Must not be called while requested columns are waiting to be computed
+ */
+void columnCache_setSampling(columnCache_t *cc, terrainSampling_e sampling);
+
+/**
+ * @brief Adds a column to the cache if it isn't already there, to be computed by
+ *        the next columnCache_generatePending
+ * @param cc A pointer to a column cache
+ * @param cx The chunk x coordinate
+ * @param cz The chunk z coordinate
+ */
+void columnCache_request(columnCache_t *cc, int cx, int cz);
+
+/**
+ * @brief Computes every requested column in parallel
+ * @param cc A pointer to a column cache
+ * @param jobs A pointer to the job pool to run on
+ */
+void columnCache_generatePending(columnCache_t *cc, jobPool_t *jobs);
+
+/**
+ * @brief Gets a column that has been requested and computed
+ * @param cc A pointer to a column cache
+ * @param cx The chunk x coordinate
+ * @param cz The chunk z coordinate
+ * @return A pointer to the column, or NULL if it isn't cached
+ * @note Safe to call from any thread while the chunk loading thread is waiting on a batch
+ */
+const chunkColumn_t *columnCache_get(const columnCache_t *cc, int cx, int cz);
+
+/**
+ * @brief Gets a column, computing it on the calling thread if it isn't cached
+ * @param cc A pointer to a column cache
+ * @param cx The chunk x coordinate
+ * @param cz The chunk z coordinate
+ * @return A pointer to the column
+ */
+const chunkColumn_t *columnCache_acquire(columnCache_t *cc, int cx, int cz);
+
+/**
+ * @brief Frees every cached column that is no longer wanted
+ * @param cc A pointer to a column cache
+ * @param keep Decides which columns to keep
+ * @param ctx Passed to keep
+ * @note Must not be called while requested columns are waiting to be computed
+ */
+void columnCache_evict(columnCache_t *cc, columnCache_keep_t keep, void *ctx);
+
+/**
+ * @brief Gets the number of cached columns
+ * @param cc A pointer to a column cache
+ * @return The number of columns
+ */
+size_t columnCache_count(const columnCache_t *cc);
+
+/**
+ * @brief Frees a column cache and every column in it
+ * @param cc A pointer to a column cache
+ */
+void columnCache_free(columnCache_t *cc);
+
+#endif
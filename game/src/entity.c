@@ -1,4 +1,5 @@
 #include "entity.h"
+#include "world.h"
 
 #define vec3_SIZE 12
 #define VELOCITY_CUTOFF 0.05f
@@ -107,23 +108,6 @@ static void handleAxisCollision(entity_t *entity,
     }
 }
 
-/**
- * @brief Converts a list of blockData_t to block_bounding_t
- * @param buf the array containing the blockData_t blocks
- * @param numBlocks the number of blocks in the array
- * @param result the array in which to store the block_bounding_t blocks
- */
-static void blockDataToBlockBounding(const blockData_t *buf, const unsigned int numBlocks, blockBounding_t *result) {
-    vec3 blockSize = {1.f, 1.f, 1.f};
-    for (int i = 0; i < numBlocks; i++) {
-        const blockData_t block = buf[numBlocks - i - 1];
-
-        vec3 position = {(float)block.x, (float)block.y, (float)block.z};
-
-        result[i] = (blockBounding_t){.data = block, .aabb = makeAABB(position, blockSize)};
-    }
-}
-
 void glm_vec3_ceil(vec3 v, vec3 dest) {
     dest[0] = ceilf(v[0]);
     dest[1] = ceilf(v[1]);
@@ -155,25 +139,32 @@ static void moveEntity(world_t *w, entity_t *entity, vec3 deltaP) {
     glm_vec3_ceil(maxPoint, maxPoint);
 
     // calculating how many blocks there are
-    const int numBlocks = (int)(maxPoint[0] - minPoint[0]) *
-                          (int)(maxPoint[1] - minPoint[1]) *
-                          (int)(maxPoint[2] - minPoint[2]);
-
-    // getting all the blocks in the range
-    blockData_t buf[numBlocks];
-
-    world_getBlocksInRange(w, minPoint, maxPoint, buf);
-
-    // converting them to blockBounding_t boxes
-    blockBounding_t blocks[numBlocks];
+    const ivec3 minBlock = { (int)minPoint[0], (int)minPoint[1], (int)minPoint[2] };
+    const ivec3 maxBlock = { (int)maxPoint[0], (int)maxPoint[1], (int)maxPoint[2] };
+    const int maxBlocks = (maxBlock[0] - minBlock[0]) * (maxBlock[1] - minBlock[1]) * (maxBlock[2] - minBlock[2]);
+
+    // making bounding boxes for the solid blocks in the range, skipping runs that
+    // are known to be air without reading them
+    blockBounding_t blocks[maxBlocks];
+    int numBlocks = 0;
+    vec3 blockSize = {1.f, 1.f, 1.f};
 
-    blockDataToBlockBounding(buf, numBlocks, blocks);
+    worldSpan_t span;
+    world_spanBegin(w, &span, minBlock, maxBlock);
+    while (world_spanNext(&span)) {
+        if (worldSpan_isAir(&span)) continue;
+        for (int i = 0; i < span.length; i++) {
+            const block_t type = worldSpan_get(&span, i);
+            if (type == BL_AIR) continue;
+
+            const blockData_t block = { .type = type, .x = span.x, .y = span.y, .z = span.z + i };
+            vec3 position = {(float)block.x, (float)block.y, (float)block.z};
+            blocks[numBlocks++] = (blockBounding_t){.data = block, .aabb = makeAABB(position, blockSize)};
+        }
+    }
 
     // resolves collisions in Y-axis
     for (int i = 0; i < numBlocks; i++) {
-        if (blocks[i].data.type == BL_AIR) {
-            continue;
-        }
         if (intersectsX(aabb, blocks[i].aabb) && intersectsZ(aabb, blocks[i].aabb)) {
             handleAxisCollision(entity, aabb, blocks[i], deltaP, 1);
         }
@@ -203,9 +194,6 @@ static void moveEntity(world_t *w, entity_t *entity, vec3 deltaP) {
 
     // resolves collisions in X-axis
     for (int i = 0; i < numBlocks; i++) {
-        if (blocks[i].data.type == BL_AIR) {
-            continue;
-        }
         if (intersectsY(aabb, blocks[i].aabb) && intersectsZ(aabb, blocks[i].aabb)) {
             handleAxisCollision(entity, aabb, blocks[i], deltaP, 0);
         }
@@ -216,9 +204,6 @@ static void moveEntity(world_t *w, entity_t *entity, vec3 deltaP) {
 
     // resolves collisions in Z-axis
     for (int i = 0; i < numBlocks; i++) {
-        if (blocks[i].data.type == BL_AIR) {
-            continue;
-        }
         if (intersectsX(aabb, blocks[i].aabb) && intersectsY(aabb, blocks[i].aabb)) {
             handleAxisCollision(entity, aabb, blocks[i], deltaP, 2);
         }
@@ -38,8 +38,6 @@ typedef struct {
     aabb_t aabb;
 } blockBounding_t;
 
-extern void world_getBlocksInRange(world_t *w, vec3 minPoint, const vec3 maxPoint, blockData_t buf[]);
-
 extern bool world_getBlock(world_t *w, const vec3 position, blockData_t *bd);
 
 /**
@@ -0,0 +1,74 @@
+#include <logging.h>
+#include <stdlib.h>
+#include "epoch.h"
+
+void epoch_init(epoch_t *e) {
+    atomic_init(&e->global, 0);
+    atomic_init(&e->reader, EPOCH_QUIESCENT);
+    e->retired = NULL;
+    e->nRetired = 0;
+    e->capacity = 0;
+}
+
+/*
+ * Both sides use sequentially consistent operations. If the reader's store of its
+ * epoch comes after the writer's check in the total order, then so do the reader's
+ * loads of shared pointers, which therefore see the object already unpublished.
+ */
+void epoch_enter(epoch_t *e) {
+    atomic_store(&e->reader, atomic_load(&e->global));
+}
+
+void epoch_exit(epoch_t *e) {
+    atomic_store(&e->reader, EPOCH_QUIESCENT);
+}
+
+void epoch_retire(epoch_t *e, void *obj, const epoch_reclaim_t reclaim, void *ctx) {
+    if (e->nRetired == e->capacity) {
+        e->capacity = e->capacity ? e->capacity * 2 : 64;
+        epochRetired_t *retired = realloc(e->retired, e->capacity * sizeof(epochRetired_t));
+        if (!retired) {
+            LOG_FATAL("epoch_retire realloc failed");
+        }
+        e->retired = retired;
+    }
+    e->retired[e->nRetired++] = (epochRetired_t){
+        .obj = obj,
+        .reclaim = reclaim,
+        .ctx = ctx,
+        .epoch = atomic_load_explicit(&e->global, memory_order_relaxed),
+    };
+}
+
+void epoch_advance(epoch_t *e) {
+    atomic_store(&e->global, atomic_load_explicit(&e->global, memory_order_relaxed) + 1);
+    const uint64_t reader = atomic_load(&e->reader);
+
+    // Retired objects are in epoch order, so everything before the first one the
+    // reader might still hold can go
+    size_t n = 0;
+    while (n < e->nRetired && (reader == EPOCH_QUIESCENT || e->retired[n].epoch < reader)) {
+        e->retired[n].reclaim(e->retired[n].ctx, e->retired[n].obj);
+        n++;
+    }
+    if (n > 0) {
+        e->nRetired -= n;
+        for (size_t i = 0; i < e->nRetired; i++) {
+            e->retired[i] = e->retired[i + n];
+        }
+    }
+}
+
+size_t epoch_pending(const epoch_t *e) {
+    return e->nRetired;
+}
+
+void epoch_free(epoch_t *e) {
+    for (size_t i = 0; i < e->nRetired; i++) {
+        e->retired[i].reclaim(e->retired[i].ctx, e->retired[i].obj);
+    }
+    free(e->retired);
+    e->retired = NULL;
+    e->nRetired = 0;
+    e->capacity = 0;
+}
@@ -0,0 +1,101 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// The reader epoch while the reader is outside a read section
+#define EPOCH_QUIESCENT UINT64_MAX
+
+/**
+ * @brief A callback that frees a retired object
+ * @param ctx The context given when the object was retired
+ * @param obj A pointer to the object
+ */
+typedef void (*epoch_reclaim_t)(void *ctx, void *obj);
+
+/**
+ * @brief An object waiting for the reader to move past it
+ */
+typedef struct {
+    /// A pointer to the object
+    void *obj;
+    /// Frees the object
+    epoch_reclaim_t reclaim;
+    /// The context passed to reclaim
+    void *ctx;
+    /// The global epoch when the object was retired
+    uint64_t epoch;
+} epochRetired_t;
+
+/**
+ * @brief Epoch-based reclamation between one writer thread and one reader thread
+ * @note The reader wraps every access to shared objects in epoch_enter and
+ *       epoch_exit, and never blocks. The writer unpublishes an object, then retires
+ *       it, and it is only reclaimed once the reader has either left its read
+ *       section or entered a new one after the next epoch_advance. Retiring,
+ *       advancing and reclaiming all happen on the writer thread.
+ */
+typedef struct {
+    /// The global epoch, only advanced by the writer
+    atomic_uint_fast64_t global;
+    /// The epoch the reader entered its read section in, or EPOCH_QUIESCENT
+    atomic_uint_fast64_t reader;
+    /// The heap-allocated list of retired objects, only used by the writer
+    epochRetired_t *retired;
+    /// The number of retired objects
+    size_t nRetired;
+    /// The capacity of the retired list
+    size_t capacity;
+} epoch_t;
+
+/**
+ * @brief Initialises an epoch
+ * @param e A pointer to an epoch
+ */
+void epoch_init(epoch_t *e);
+
+/**
+ * @brief Starts a read section on the reader thread
+ * @param e A pointer to an epoch
+ */
+void epoch_enter(epoch_t *e);
+
+/**
+ * @brief Ends a read section on the reader thread
+ * @param e A pointer to an epoch
+ */
+void epoch_exit(epoch_t *e);
+
+/**
+ * @brief Queues an object that the reader can no longer newly reach to be reclaimed
+ * @param e A pointer to an epoch
+ * @param obj A pointer to the object
+ * @param reclaim Frees the object
+ * @param ctx The context passed to reclaim
+ */
+void epoch_retire(epoch_t *e, void *obj, epoch_reclaim_t reclaim, void *ctx);
+
+/**
+ * @brief Advances the global epoch and reclaims every retired object the reader
+ *        has moved past
+ * @param e A pointer to an epoch
+ */
+void epoch_advance(epoch_t *e);
+
+/**
+ * @brief Gets the number of retired objects waiting to be reclaimed
+ * @param e A pointer to an epoch
+ * @return The number of objects
+ */
+size_t epoch_pending(const epoch_t *e);
+
+/**
+ * @brief Reclaims every retired object and frees an epoch
+ * @param e A pointer to an epoch
+ * @note The reader must have stopped
+ */
+void epoch_free(epoch_t *e);
+
+#endif
@@ -177,21 +177,20 @@ void processPlayerInput(GLFWwindow *window, camera_t *camera, player_t *player,
                 maxPoint[i] = bottomLeft[i] + 1;
             }
         }
-        const int numBlocks = (int)(maxPoint[0] - minPoint[0]) *
-                          (int)(maxPoint[1] - minPoint[1]) *
-                          (int)(maxPoint[2] - minPoint[2]);
-
-        // getting all the blocks in the range
-        blockData_t buf[numBlocks];
-
-        world_getBlocksInRange(w, minPoint, maxPoint, buf);
+        const ivec3 minBlock = { (int)minPoint[0], (int)minPoint[1], (int)minPoint[2] };
+        const ivec3 maxBlock = { (int)maxPoint[0], (int)maxPoint[1], (int)maxPoint[2] };
 
         printf("static const structureBlock_t generatedPattern[] = {\n");
 
-        for (int i = 0; i < numBlocks; i++) {
-            const blockData_t block = buf[i];
-            if (block.type!= BL_AIR) {
-                printf("    {%d, %d, %d, %d, 1.f, false},\n", block.type, block.x - (int)origin[0], block.y - (int)origin[1], block.z - (int)origin[2]);
+        worldSpan_t span;
+        world_spanBegin(w, &span, minBlock, maxBlock);
+        while (world_spanNext(&span)) {
+            if (worldSpan_isAir(&span)) continue;
+            for (int i = 0; i < span.length; i++) {
+                const block_t block = worldSpan_get(&span, i);
+                if (block != BL_AIR) {
+                    printf("    {%d, %d, %d, %d, 1.f, false},\n", block, span.x - (int)origin[0], span.y - (int)origin[1], span.z + i - (int)origin[2]);
+                }
             }
         }
 
@@ -0,0 +1,178 @@
+#include <logging.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "jobpool.h"
+
+/**
+ * @brief A worker thread's argument
+ */
+typedef struct {
+    jobPool_t *pool;
+    int index;
+} workerArg_t;
+
+/**
+ * @brief Takes an item from the back of a thread's own deque
+ * @param d A pointer to the deque
+ * @param i A pointer to where to store the item index
+ * @return Whether there was an item
+ */
+static bool takeOwn(jobDeque_t *d, size_t *i) {
+    pthread_mutex_lock(&d->lock);
+    const bool found = d->top < d->bottom;
+    if (found) {
+        *i = --d->bottom;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+/**
+ * @brief Steals an item from the front of another thread's deque
+ * @param p A pointer to a job pool
+ * @param self The index of the stealing thread
+ * @param i A pointer to where to store the item index
+ * @return Whether there was an item to steal
+ */
+static bool steal(jobPool_t *p, const int self, size_t *i) {
+    for (int k = 1; k < p->nThreads; k++) {
+        jobDeque_t *d = &p->deques[(self + k) % p->nThreads];
+        pthread_mutex_lock(&d->lock);
+        const bool found = d->top < d->bottom;
+        if (found) {
+            *i = d->top++;
+        }
+        pthread_mutex_unlock(&d->lock);
+        if (found) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Runs jobs until every deque is empty
+ * @param p A pointer to a job pool
+ * @param self The index of the running thread
+ */
+static void drain(jobPool_t *p, const int self) {
+    size_t i;
+    while (takeOwn(&p->deques[self], &i) || steal(p, self, &i)) {
+        p->job(p->ctx, p->items[i]);
+    }
+}
+
+static void *workerThread(void *arg) {
+    jobPool_t *p = ((workerArg_t *)arg)->pool;
+    const int index = ((workerArg_t *)arg)->index;
+    free(arg);
+
+    uint64_t seen = 0;
+    while (true) {
+        pthread_mutex_lock(&p->lock);
+        while (p->generation == seen && !p->quit) {
+            pthread_cond_wait(&p->start, &p->lock);
+        }
+        if (p->quit) {
+            pthread_mutex_unlock(&p->lock);
+            return NULL;
+        }
+        seen = p->generation;
+        pthread_mutex_unlock(&p->lock);
+
+        drain(p, index);
+
+        pthread_mutex_lock(&p->lock);
+        if (--p->nBusy == 0) {
+            pthread_cond_signal(&p->done);
+        }
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+void jobPool_init(jobPool_t *p, const int nThreads) {
+    p->nThreads = nThreads > 1 ? nThreads : 1;
+    p->generation = 0;
+    p->quit = false;
+    p->nBusy = 0;
+    p->job = NULL;
+    p->ctx = NULL;
+    p->items = NULL;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    p->deques = malloc(p->nThreads * sizeof(jobDeque_t));
+    p->threads = malloc(p->nThreads * sizeof(pthread_t));
+    if (!p->deques || !p->threads) {
+        LOG_FATAL("jobPool allocation failed");
+    }
+    for (int i = 0; i < p->nThreads; i++) {
+        pthread_mutex_init(&p->deques[i].lock, NULL);
+        p->deques[i].top = 0;
+        p->deques[i].bottom = 0;
+    }
+    for (int i = 1; i < p->nThreads; i++) {
+        workerArg_t *arg = malloc(sizeof(workerArg_t));
+        if (!arg) {
+            LOG_FATAL("jobPool allocation failed");
+        }
+        *arg = (workerArg_t){ .pool = p, .index = i };
+        if (pthread_create(&p->threads[i - 1], NULL, workerThread, arg) != 0) {
+            LOG_FATAL("Couldn't start job pool thread");
+        }
+    }
+}
+
+void jobPool_run(jobPool_t *p, const jobPool_job_t job, void *ctx, void **items, const size_t n) {
+    if (n == 0) return;
+    if (p->nThreads == 1) {
+        for (size_t i = 0; i < n; i++) {
+            job(ctx, items[i]);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&p->lock);
+    p->job = job;
+    p->ctx = ctx;
+    p->items = items;
+    // Hands out contiguous shares, so neighbouring chunks tend to stay on one thread
+    for (int i = 0; i < p->nThreads; i++) {
+        p->deques[i].top = n * i / p->nThreads;
+        p->deques[i].bottom = n * (i + 1) / p->nThreads;
+    }
+    p->nBusy = p->nThreads - 1;
+    p->generation++;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+
+    drain(p, 0);
+
+    pthread_mutex_lock(&p->lock);
+    while (p->nBusy > 0) {
+        pthread_cond_wait(&p->done, &p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+}
+
+void jobPool_free(jobPool_t *p) {
+    pthread_mutex_lock(&p->lock);
+    p->quit = true;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 1; i < p->nThreads; i++) {
+        pthread_join(p->threads[i - 1], NULL);
+    }
+    for (int i = 0; i < p->nThreads; i++) {
+        pthread_mutex_destroy(&p->deques[i].lock);
+    }
+    pthread_cond_destroy(&p->done);
+    pthread_cond_destroy(&p->start);
+    pthread_mutex_destroy(&p->lock);
+    free(p->deques);
+    free(p->threads);
+}
+
+int jobPool_defaultThreads(void) {
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 2 ? (int)(cores - 1) : 1;
+}
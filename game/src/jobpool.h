@@ -0,0 +1,98 @@
+#ifndef JOBPOOL_H
+#define JOBPOOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A job run by a job pool on one item of a batch
+ * @param ctx The context given for the batch
+ * @param item The item
+ */
+typedef void (*jobPool_job_t)(void *ctx, void *item);
+
+/**
+ * @brief The part of a batch a thread has left to run, as a range of item indices
+ * @note The owning thread takes items from the back and other threads steal from
+ *       the front, so an owner and a thief only contend over the last item.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    /// The index of the first item left
+    size_t top;
+    /// One past the index of the last item left
+    size_t bottom;
+} jobDeque_t;
+
+/**
+ * @brief A fixed set of threads that run batches of independent jobs with work stealing
+ * @note The thread submitting a batch runs jobs as well, and jobPool_run returns once
+ *       every job of the batch has finished. Each thread starts on an even share of
+ *       the batch and steals from the others once its own share runs out. Only one
+ *       thread may submit batches.
+ */
+typedef struct {
+    /// The number of threads running jobs, including the submitting thread
+    int nThreads;
+    /// The heap-allocated worker threads, nThreads - 1 of them
+    pthread_t *threads;
+    /// The heap-allocated deques, one per thread, the first being the submitting thread's
+    jobDeque_t *deques;
+
+    /// Protects the batch fields below and wakes the workers
+    pthread_mutex_t lock;
+    /// Signalled when a batch starts or the pool is freed
+    pthread_cond_t start;
+    /// Signalled when the last worker finishes a batch
+    pthread_cond_t done;
+    /// Incremented for every batch, so workers can tell a new one has started
+    uint64_t generation;
+    /// Set when the pool is being freed
+    bool quit;
+    /// The number of workers still running the current batch
+    int nBusy;
+
+    /// The current batch's job
+    jobPool_job_t job;
+    /// The current batch's context
+    void *ctx;
+    /// The current batch's items
+    void **items;
+} jobPool_t;
+
+/**
+ * @brief Initialises a job pool and starts its threads
+ * @param p A pointer to a job pool
+ * @param nThreads The number of threads to run jobs on, including the submitting
+ *        thread, so 1 runs every batch on the submitting thread alone
+ */
+void jobPool_init(jobPool_t *p, int nThreads);
+
+/**
+ * @brief Runs a job on every item of a batch and waits for them all to finish
+ * @param p A pointer to a job pool
+ * @param job The job
+ * @param ctx The context passed to every job
+ * @param items The items
+ * @param n The number of items
+ * @note Jobs run in no particular order and on any thread, so must not depend on
+ *       each other
+ */
+void jobPool_run(jobPool_t *p, jobPool_job_t job, void *ctx, void **items, size_t n);
+
+/**
+ * @brief Stops a job pool's threads and frees it
+ * @param p A pointer to a job pool
+ */
+void jobPool_free(jobPool_t *p);
+
+/**
+ * @brief Gets a sensible number of job threads for this machine, which leaves one
+ *        core for the render thread
+ * @return The number of threads, at least 1
+ */
+int jobPool_defaultThreads(void);
+
+#endif
@@ -2,142 +2,21 @@
 #include <string.h>
 #include "lighting.h"
 
-static void sumLight(world_t *w, const chunk_t *c, ivec3 nPos, int *sum, int *count) {
-    ivec3 chunkOffset = { 0, 0, 0 };
-    for (int n = 0; n < 3; ++n) {
-        if (nPos[n] < 0) {
-            nPos[n] = CHUNK_SIZE - 1;
-            chunkOffset[n] = -1;
-        } else if (nPos[n] >= CHUNK_SIZE) {
-            nPos[n] = 0;
-            chunkOffset[n] = 1;
-        }
-    }
-    if (chunkOffset[0] == 0 && chunkOffset[1] == 0 && chunkOffset[2] == 0) {
-        const int lv = c->lightMap[nPos[0]][nPos[1]][nPos[2]];
-        *sum += glm_imax(lv & LIGHT_TORCH_MASK, (lv & LIGHT_SUN_MASK) >> 4);
-        (*count)++;
-    } else {
-        ivec3 cPos = { c->cx, c->cy, c->cz };
-        glm_ivec3_add(cPos, chunkOffset, cPos);
-        const chunk_t *nChunk = world_getFullyLoadedChunk(w, cPos[0], cPos[1], cPos[2]);
-        if (nChunk) {
-            const int lv = nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]];
-            *sum += glm_imax(lv & LIGHT_TORCH_MASK, (lv & LIGHT_SUN_MASK) >> 4);
-            (*count)++;
-        }
-    }
-}
-
-// computes the light value of a vertex by averaging the 4 light values in the direction of the normal
-float computeVertexLight(world_t *w,
-                         const chunk_t *c,
-                         const int vx,
-                         const int vy,
-                         const int vz,
-                         const direction_e dir) {
-    const int vertexOffset[2] = { 0, -1 };
-
-    int count = 0;
-    int sum = 0;
-
-    switch (dir) {
-        case DIR_PLUSZ: {
-            for (int i = 0; i < 2; ++i) {
-                for (int j = 0; j < 2; ++j) {
-                    ivec3 nPos = { vx + vertexOffset[i], vy + vertexOffset[j], vz };
-                    sumLight(w, c, nPos, &sum, &count);
-                }
-            }
-            break;
-        }
-        case DIR_MINUSZ: {
-            const int dz = -1;
-            for (int i = 0; i < 2; ++i) {
-                for (int j = 0; j < 2; ++j) {
-                    const int nx = vx + vertexOffset[i];
-                    const int ny = vy + vertexOffset[j];
-                    const int nz = vz + dz;
-                    ivec3 nPos = { nx, ny, nz };
-                    sumLight(w, c, nPos, &sum, &count);
-                }
-            }
-            break;
-        }
-        case DIR_PLUSY: {
-            for (int i = 0; i < 2; ++i) {
-                for (int j = 0; j < 2; ++j) {
-                    const int nx = vx + vertexOffset[i];
-                    const int nz = vz + vertexOffset[j];
-                    const int ny = vy;
-                    ivec3 nPos = { nx, ny, nz };
-                    sumLight(w, c, nPos, &sum, &count);
-                }
-            }
-            break;
-        }
-        case DIR_MINUSY: {
-            const int dy = -1;
-            for (int i = 0; i < 2; ++i) {
-                for (int j = 0; j < 2; ++j) {
-                    const int nx = vx + vertexOffset[i];
-                    const int nz = vz + vertexOffset[j];
-                    const int ny = vy + dy;
-                    ivec3 nPos = { nx, ny, nz };
-                    sumLight(w, c, nPos, &sum, &count);
-                }
-            }
-            break;
-        }
-        case DIR_PLUSX: {
-            for (int i = 0; i < 2; ++i) {
-                for (int j = 0; j < 2; ++j) {
-                    const int ny = vy + vertexOffset[i];
-                    const int nz = vz + vertexOffset[j];
-                    const int nx = vx;
-                    ivec3 nPos = { nx, ny, nz };
-                    sumLight(w, c, nPos, &sum, &count);
-                }
-            }
-            break;
-        }
-        case DIR_MINUSX: {
-            const int dx = -1;
-            for (int i = 0; i < 2; ++i) {
-                for (int j = 0; j < 2; ++j) {
-                    const int ny = vy + vertexOffset[i];
-                    const int nz = vz + vertexOffset[j];
-                    const int nx = vx + dx;
-                    ivec3 nPos = { nx, ny, nz };
-                    sumLight(w, c, nPos, &sum, &count);
-                }
-            }
-            break;
-        }
-        default:
-            LOG_FATAL("Invalid direction enum in computeVertexLight");
-    }
-
-    if (count == 0) {
-        return 0.0f;
-    }
-    return ((float)sum / (float)count) / (float)LIGHT_MAX_VALUE;
-}
-
 // propagate darkness across chunks using a BFS flood fill until queue is empty
-static void processTorchLightDeletion(chunk_t *c, world_t *w) {
+static void processTorchLightDeletion(chunk_t *c) {
     while (c->lightTorchDeletionQueue.size > 0) {
         lightQueueItem_t head = queue_pop(&c->lightTorchDeletionQueue);
-        unsigned char lightLevel = EXTRACT_TORCH(c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]]);
+        unsigned char lightLevel = EXTRACT_TORCH(chunk_light(c, head.pos[0], head.pos[1], head.pos[2]));
         if (lightLevel <= 0) {
             continue;
         }
-        if (!BL_TRANSPARENT(c->blocks[head.pos[0]][head.pos[1]][head.pos[2]])) {
+        const block_t block = chunk_getBlock(c, head.pos[0], head.pos[1], head.pos[2]);
+        if (!BL_TRANSPARENT(block)) {
             continue;
         }
         lightLevel = head.lightValue;
         // set torchlight to 0
-        c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]] &= LIGHT_SUN_MASK;
+        chunk_light(c, head.pos[0], head.pos[1], head.pos[2]) &= LIGHT_SUN_MASK;
 
         for (int dir = 0; dir < 6; ++dir) {
             ivec3 dirVec;
@@ -158,8 +37,9 @@ static void processTorchLightDeletion(chunk_t *c, world_t *w) {
             }
             if (offset[0] == 0 && offset[1] == 0 && offset[2] == 0) {
                 // propagate darkness within current chunk
-                if (BL_TRANSPARENT(c->blocks[nPos[0]][nPos[1]][nPos[2]])) {
-                    const unsigned char neighbourLight = EXTRACT_TORCH(c->lightMap[nPos[0]][nPos[1]][nPos[2]]);
+                const block_t nBlock = chunk_getBlock(c, nPos[0], nPos[1], nPos[2]);
+                if (BL_TRANSPARENT(nBlock)) {
+                    const unsigned char neighbourLight = EXTRACT_TORCH(chunk_light(c, nPos[0], nPos[1], nPos[2]));
                     lightQueueItem_t nItem = { .lightValue = neighbourLight };
                     memcpy(&nItem.pos, &nPos, sizeof(ivec3));
                     if (neighbourLight < lightLevel && neighbourLight != 0) {
@@ -171,17 +51,16 @@ static void processTorchLightDeletion(chunk_t *c, world_t *w) {
                 }
             } else {
                 // propagate darkness within neighbouring chunk
-                ivec3 cPos = { c->cx, c->cy, c->cz };
-                glm_ivec3_add(cPos, offset, cPos);
-                chunk_t *nChunk = world_getFullyLoadedChunk(w, cPos[0], cPos[1], cPos[2]);
+                chunk_t *nChunk = chunk_neighbour(c, offset[0], offset[1], offset[2]);
                 if (nChunk == NULL) {
                     LOG_ERROR("Attempted to propagate torch darkness to unloaded chunk");
                     // TODO: think about what should happen
                 } else {
-                    if (!BL_TRANSPARENT(nChunk->blocks[nPos[0]][nPos[1]][nPos[2]])) {
+                    const block_t nBlock = chunk_getBlock(nChunk, nPos[0], nPos[1], nPos[2]);
+                    if (!BL_TRANSPARENT(nBlock)) {
                         continue;
                     }
-                    const unsigned char neighbourLight = EXTRACT_TORCH(nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]]);
+                    const unsigned char neighbourLight = EXTRACT_TORCH(chunk_light(nChunk, nPos[0], nPos[1], nPos[2]));
                     lightQueueItem_t nItem = { .lightValue = neighbourLight };
                     memcpy(&nItem.pos, &nPos, sizeof(ivec3));
                     if (neighbourLight < lightLevel && neighbourLight != 0) {
@@ -201,13 +80,14 @@ static void processTorchLightInsertion(chunk_t *c, world_t *w) {
     // propagate light
     while (c->lightTorchInsertionQueue.size > 0) {
         lightQueueItem_t head = queue_pop(&c->lightTorchInsertionQueue);
-        unsigned char lightLevel = LIGHT_TORCH_MASK & c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]];
-        if ((c->blocks[head.pos[0]][head.pos[1]][head.pos[2]]) != BL_AIR && c->blocks[head.pos[0]][head.pos[1]][head.pos[2]] != BL_GLOWSTONE) {
+        unsigned char lightLevel = LIGHT_TORCH_MASK & chunk_light(c, head.pos[0], head.pos[1], head.pos[2]);
+        const block_t block = chunk_getBlock(c, head.pos[0], head.pos[1], head.pos[2]);
+        if (block != BL_AIR && block != BL_GLOWSTONE) {
             continue;
         }
         if (lightLevel < head.lightValue) {
-            c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]] =
-                (c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]] & LIGHT_SUN_MASK) | (head.lightValue & LIGHT_TORCH_MASK);
+            chunk_light(c, head.pos[0], head.pos[1], head.pos[2]) =
+                (chunk_light(c, head.pos[0], head.pos[1], head.pos[2]) & LIGHT_SUN_MASK) | (head.lightValue & LIGHT_TORCH_MASK);
             lightLevel = head.lightValue;
         }
 
@@ -236,31 +116,30 @@ static void processTorchLightInsertion(chunk_t *c, world_t *w) {
             }
             if (offset[0] == 0 && offset[1] == 0 && offset[2] == 0) {
                 // propagate light to current chunk
-                if (BL_TRANSPARENT(c->blocks[nPos[0]][nPos[1]][nPos[2]]) &&
-                    LIGHT_TORCH_MASK & c->lightMap[nPos[0]][nPos[1]][nPos[2]] < newLight) {
-                    c->lightMap[nPos[0]][nPos[1]][nPos[2]] =
-                        (c->lightMap[nPos[0]][nPos[1]][nPos[2]] & LIGHT_SUN_MASK) | (newLight & LIGHT_TORCH_MASK);
+                const block_t nBlock = chunk_getBlock(c, nPos[0], nPos[1], nPos[2]);
+                if (BL_TRANSPARENT(nBlock) &&
+                    LIGHT_TORCH_MASK & chunk_light(c, nPos[0], nPos[1], nPos[2]) < newLight) {
+                    chunk_light(c, nPos[0], nPos[1], nPos[2]) =
+                        (chunk_light(c, nPos[0], nPos[1], nPos[2]) & LIGHT_SUN_MASK) | (newLight & LIGHT_TORCH_MASK);
                     lightQueueItem_t nItem = { .lightValue = newLight };
                     memcpy(&nItem.pos, &nPos, sizeof(ivec3));
                     queue_push(&c->lightTorchInsertionQueue, nItem);
                 }
                 c->tainted = true;
             } else {
-                ivec3 cPos = { c->cx, c->cy, c->cz };
-                glm_ivec3_add(cPos, offset, cPos);
-                chunk_t *nChunk = world_getFullyLoadedChunk(w, cPos[0], cPos[1], cPos[2]);
+                chunk_t *nChunk = chunk_neighbour(c, offset[0], offset[1], offset[2]);
                 if (nChunk == NULL) {
-                    nChunk = world_loadChunk(w, cPos[0], cPos[1], cPos[2], LL_INIT, REL_CHILD)->chunk;
+                    nChunk = world_loadChunk(w, c->cx + offset[0], c->cy + offset[1], c->cz + offset[2], LL_INIT, REL_CHILD)->chunk;
                 } else {
-                    if ((nChunk->blocks[nPos[0]][nPos[1]][nPos[2]]) != BL_AIR) {
+                    if (chunk_getBlock(nChunk, nPos[0], nPos[1], nPos[2]) != BL_AIR) {
                         nChunk->tainted = true;
                         continue;
                     }
-                    if (EXTRACT_TORCH(nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]]) >= newLight) {
+                    if (EXTRACT_TORCH(chunk_light(nChunk, nPos[0], nPos[1], nPos[2])) >= newLight) {
                         continue;
                     }
-                    nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]] =
-                        (nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]] & LIGHT_SUN_MASK) | (newLight & LIGHT_TORCH_MASK);
+                    chunk_light(nChunk, nPos[0], nPos[1], nPos[2]) =
+                        (chunk_light(nChunk, nPos[0], nPos[1], nPos[2]) & LIGHT_SUN_MASK) | (newLight & LIGHT_TORCH_MASK);
                 }
                 lightQueueItem_t nItem = { .lightValue = newLight };
                 memcpy(&nItem.pos, &nPos, sizeof(ivec3));
@@ -273,13 +152,13 @@ static void processTorchLightInsertion(chunk_t *c, world_t *w) {
 static void processSunLightInsertion(chunk_t *c, world_t *w) {
     while (c->lightSunInsertionQueue.size > 0) {
         lightQueueItem_t head = queue_pop(&c->lightSunInsertionQueue);
-        unsigned char lightLevel = EXTRACT_SUN(c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]]);
-        if (c->blocks[head.pos[0]][head.pos[1]][head.pos[2]] != BL_AIR) {
+        unsigned char lightLevel = EXTRACT_SUN(chunk_light(c, head.pos[0], head.pos[1], head.pos[2]));
+        if (chunk_getBlock(c, head.pos[0], head.pos[1], head.pos[2]) != BL_AIR) {
             continue;
         }
         if (lightLevel < head.lightValue) {
-            c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]] =
-                    (c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]] & LIGHT_TORCH_MASK)
+            chunk_light(c, head.pos[0], head.pos[1], head.pos[2]) =
+                    (chunk_light(c, head.pos[0], head.pos[1], head.pos[2]) & LIGHT_TORCH_MASK)
                             | ((head.lightValue & LIGHT_TORCH_MASK) << 4);
             lightLevel = head.lightValue;
         }
@@ -315,10 +194,10 @@ static void processSunLightInsertion(chunk_t *c, world_t *w) {
             }
             if (offset[0] == 0 && offset[1] == 0 && offset[2] == 0) {
                 // propagate light to current chunk
-                if (c->blocks[nPos[0]][nPos[1]][nPos[2]] == BL_AIR &&
-                    EXTRACT_SUN(c->lightMap[nPos[0]][nPos[1]][nPos[2]]) < newNeighbourLevel) {
-                    c->lightMap[nPos[0]][nPos[1]][nPos[2]] =
-                            (c->lightMap[nPos[0]][nPos[1]][nPos[2]] & LIGHT_TORCH_MASK)
+                if (chunk_getBlock(c, nPos[0], nPos[1], nPos[2]) == BL_AIR &&
+                    EXTRACT_SUN(chunk_light(c, nPos[0], nPos[1], nPos[2])) < newNeighbourLevel) {
+                    chunk_light(c, nPos[0], nPos[1], nPos[2]) =
+                            (chunk_light(c, nPos[0], nPos[1], nPos[2]) & LIGHT_TORCH_MASK)
                                     | ((newNeighbourLevel & LIGHT_TORCH_MASK) << 4);
                     lightQueueItem_t nItem = { .lightValue = newNeighbourLevel };
                     memcpy(&nItem.pos, &nPos, sizeof(ivec3));
@@ -327,22 +206,20 @@ static void processSunLightInsertion(chunk_t *c, world_t *w) {
                 }
             } else {
                 // propagate light to neighbouring chunk
-                ivec3 cPos = { c->cx, c->cy, c->cz };
-                glm_ivec3_add(cPos, offset, cPos);
-                chunk_t *nChunk = world_getFullyLoadedChunk(w, cPos[0], cPos[1], cPos[2]);
+                chunk_t *nChunk = chunk_neighbour(c, offset[0], offset[1], offset[2]);
                 if (nChunk == NULL) {
                     continue;
-                    nChunk = world_loadChunk(w, cPos[0], cPos[1], cPos[2], LL_INIT, REL_CHILD)->chunk;
+                    nChunk = world_loadChunk(w, c->cx + offset[0], c->cy + offset[1], c->cz + offset[2], LL_INIT, REL_CHILD)->chunk;
                 } else {
-                    if (nChunk->blocks[nPos[0]][nPos[1]][nPos[2]] != BL_AIR) {
+                    if (chunk_getBlock(nChunk, nPos[0], nPos[1], nPos[2]) != BL_AIR) {
                         nChunk->tainted = true;
                         continue;
                     }
-                    if (EXTRACT_SUN(nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]]) >= newNeighbourLevel) {
+                    if (EXTRACT_SUN(chunk_light(nChunk, nPos[0], nPos[1], nPos[2])) >= newNeighbourLevel) {
                         continue;
                     }
-                    nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]] =
-                            (nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]] & LIGHT_TORCH_MASK)
+                    chunk_light(nChunk, nPos[0], nPos[1], nPos[2]) =
+                            (chunk_light(nChunk, nPos[0], nPos[1], nPos[2]) & LIGHT_TORCH_MASK)
                                     | ((newNeighbourLevel & LIGHT_TORCH_MASK) << 4);
                 }
                 lightQueueItem_t nItem = { .lightValue = newNeighbourLevel };
@@ -358,13 +235,13 @@ static void processSunLightInsertion(chunk_t *c, world_t *w) {
 static void processSunLightDeletion(chunk_t *c, world_t *w) {
     while (c->lightSunDeletionQueue.size > 0) {
         lightQueueItem_t head = queue_pop(&c->lightSunDeletionQueue);
-        unsigned char lightLevel = EXTRACT_SUN(c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]]);
+        unsigned char lightLevel = EXTRACT_SUN(chunk_light(c, head.pos[0], head.pos[1], head.pos[2]));
         if (lightLevel <= 0) {
             continue;
         }
         lightLevel = head.lightValue;
         // set sunlight to 0
-        c->lightMap[head.pos[0]][head.pos[1]][head.pos[2]] &= LIGHT_TORCH_MASK;
+        chunk_light(c, head.pos[0], head.pos[1], head.pos[2]) &= LIGHT_TORCH_MASK;
 
         for (int dir = 0; dir < 6; ++dir) {
             ivec3 dirVec;
@@ -383,8 +260,9 @@ static void processSunLightDeletion(chunk_t *c, world_t *w) {
                 continue;
             }
 
-            const unsigned char neighbourLight = EXTRACT_SUN(c->lightMap[nPos[0]][nPos[1]][nPos[2]]);
-            if ((c->blocks[nPos[0]][nPos[1]][nPos[2]] == BL_AIR || c->blocks[nPos[0]][nPos[1]][nPos[2]] == BL_LEAF)) {
+            const unsigned char neighbourLight = EXTRACT_SUN(chunk_light(c, nPos[0], nPos[1], nPos[2]));
+            const block_t nBlock = chunk_getBlock(c, nPos[0], nPos[1], nPos[2]);
+            if (nBlock == BL_AIR || nBlock == BL_LEAF) {
                 lightQueueItem_t nItem = { .lightValue = neighbourLight };
                 memcpy(&nItem.pos, &nPos, sizeof(ivec3));
                 if (dir == DIR_MINUSY || (neighbourLight < lightLevel && neighbourLight != 0)) {
@@ -403,6 +281,6 @@ void chunk_processLightInsertion(chunk_t *c, world_t *w) {
 }
 
 void chunk_processLightDeletion(chunk_t *c, world_t *w) {
-    processTorchLightDeletion(c, w);
+    processTorchLightDeletion(c);
     processSunLightDeletion(c, w);
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <logging.h>
+#include <stdlib.h>
+#include "loadqueue.h"
+
+void loadQueue_init(loadQueue_t *q) {
+    q->data = NULL;
+    q->size = 0;
+    q->capacity = 0;
+}
+
+void loadQueue_free(loadQueue_t *q) {
+    free(q->data);
+    q->data = NULL;
+    q->size = 0;
+    q->capacity = 0;
+}
+
+/**
+ * @brief Moves a request towards the root until its parent comes before it
+ * @param q A pointer to a load queue
+ * @param i The index of the request
+ */
+static void siftUp(const loadQueue_t *q, size_t i) {
+    const loadRequest_t r = q->data[i];
+    while (i > 0) {
+        const size_t parent = (i - 1) / 2;
+        if (q->data[parent].priority <= r.priority) break;
+        q->data[i] = q->data[parent];
+        i = parent;
+    }
+    q->data[i] = r;
+}
+
+/**
+ * @brief Moves a request towards the leaves until both children come after it
+ * @param q A pointer to a load queue
+ * @param i The index of the request
+ */
+static void siftDown(const loadQueue_t *q, size_t i) {
+    const loadRequest_t r = q->data[i];
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= q->size) break;
+        if (child + 1 < q->size && q->data[child + 1].priority < q->data[child].priority) {
+            child++;
+        }
+        if (r.priority <= q->data[child].priority) break;
+        q->data[i] = q->data[child];
+        i = child;
+    }
+    q->data[i] = r;
+}
+
+void loadQueue_push(loadQueue_t *q, const loadRequest_t r) {
+    if (q->size == q->capacity) {
+        const size_t capacity = q->capacity ? q->capacity * 2 : 256;
+        loadRequest_t *data = realloc(q->data, capacity * sizeof(loadRequest_t));
+        if (!data) {
+            LOG_FATAL("loadQueue realloc failed");
+        }
+        q->data = data;
+        q->capacity = capacity;
+    }
+    q->data[q->size] = r;
+    siftUp(q, q->size++);
+}
+
+bool loadQueue_pop(loadQueue_t *q, loadRequest_t *r) {
+    if (q->size == 0) return false;
+    *r = q->data[0];
+    q->data[0] = q->data[--q->size];
+    if (q->size > 0) {
+        siftDown(q, 0);
+    }
+    return true;
+}
+
+void loadQueue_reprioritise(loadQueue_t *q,
+                            const loadQueue_priority_t priority,
+                            const loadQueue_drop_t drop,
+                            void *ctx) {
+    size_t kept = 0;
+    for (size_t i = 0; i < q->size; i++) {
+        loadRequest_t r = q->data[i];
+        r.priority = priority(ctx, &r);
+        if (r.priority < 0) {
+            if (drop) drop(ctx, &r);
+            continue;
+        }
+        q->data[kept++] = r;
+    }
+    q->size = kept;
+    // Floyd's heap construction, sifting down every parent from the last one up
+    for (size_t i = q->size / 2; i-- > 0;) {
+        siftDown(q, i);
+    }
+}
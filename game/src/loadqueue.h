@@ -0,0 +1,82 @@
+#ifndef LOADQUEUE_H
+#define LOADQUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief A request to generate a chunk
+ */
+typedef struct {
+    /// The chunk's coordinates
+    int cx, cy, cz;
+    /// The request's priority, lower values are served first
+    float priority;
+} loadRequest_t;
+
+/**
+ * @brief Gives a request its current priority
+ * @param ctx The context given to loadQueue_reprioritise
+ * @param r A pointer to the request
+ * @return The request's new priority, or a negative value to drop it
+ */
+typedef float (*loadQueue_priority_t)(void *ctx, const loadRequest_t *r);
+
+/**
+ * @brief Told about a request removed from the queue for having a negative priority
+ * @param ctx The context given to loadQueue_reprioritise
+ * @param r A pointer to the request
+ */
+typedef void (*loadQueue_drop_t)(void *ctx, const loadRequest_t *r);
+
+/**
+ * @brief A binary min-heap of chunk generation requests, ordered by priority
+ */
+typedef struct {
+    /// The heap-allocated requests, in heap order
+    loadRequest_t *data;
+    /// The number of requests
+    size_t size;
+    /// The number of requests data can hold
+    size_t capacity;
+} loadQueue_t;
+
+/**
+ * @brief Initialises an empty load queue
+ * @param q A pointer to a load queue
+ */
+void loadQueue_init(loadQueue_t *q);
+
+/**
+ * @brief Frees a load queue
+ * @param q A pointer to a load queue
+ */
+void loadQueue_free(loadQueue_t *q);
+
+/**
+ * @brief Adds a request to a load queue
+ * @param q A pointer to a load queue
+ * @param r The request
+ */
+void loadQueue_push(loadQueue_t *q, loadRequest_t r);
+
+/**
+ * @brief Takes the request with the lowest priority value from a load queue
+ * @param q A pointer to a load queue
+ * @param r A pointer to where to store the request
+ * @return Whether there was a request
+ */
+bool loadQueue_pop(loadQueue_t *q, loadRequest_t *r);
+
+/**
+ * @brief Recomputes the priority of every request and restores the heap order
+ * @param q A pointer to a load queue
+ * @param priority The function giving each request its new priority
+ * @param drop The function told about each request removed, or NULL
+ * @param ctx The context passed to the functions
+ * @note Requests given a negative priority are removed. This is O(n), so it suits
+ *       being run once per chunk loading pass when the view has moved.
+ */
+void loadQueue_reprioritise(loadQueue_t *q, loadQueue_priority_t priority, loadQueue_drop_t drop, void *ctx);
+
+#endif
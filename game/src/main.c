@@ -5,13 +5,13 @@
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdio.h>
-#include <time.h>
 #include "analytics.h"
 #include "camera.h"
 #include "entity.h"
 #include "input.h"
 #include "player.h"
 #include "rendering.h"
+#include "settings.h"
 #include "world.h"
 
 #include "input.h"
@@ -87,10 +87,10 @@ struct chunkWorkerData {
 void *chunkWorker(void *arg) {
     struct chunkWorkerData *data = (struct chunkWorkerData *)arg;
 
-    const struct timespec ts = { .tv_sec = 0, .tv_nsec = 10 };
-
+    // Sleeps until something changes which chunks should be loaded, lit or meshed,
+    // so an idle player costs nothing
     while (atomic_load_explicit(&data->run, memory_order_acquire)) {
-        nanosleep(&ts, NULL);
+        world_waitForChunkWork(data->world);
         world_doChunkLoading(data->world);
     }
     atomic_store_explicit(&data->finished, true, memory_order_release);
@@ -98,12 +98,14 @@ void *chunkWorker(void *arg) {
     return (void *) 0;
 }
 
-int main(void) {
+int main(int argc, char **argv) {
     /*
         Initialisation
     */
 
     log_init(stdout);
+    settings_t settings;
+    settings_load(&settings, argc, argv);
     initialiseWindow();
     rendering_init(actual_screen_width, actual_screen_height);
 
@@ -120,6 +122,11 @@ int main(void) {
     // World setup
     world_t world;
     world_init(&world, 40);
+    world_setViewDistance(&world, settings.viewDistance);
+    world_setMemoryBudget(&world, settings.memoryBudget);
+    world_setGenerationThreads(&world, settings.generationThreads);
+    world_setLodDistance(&world, settings.lodDistance);
+    world_setTerrainSampling(&world, settings.coarseTerrain ? TERRAIN_COARSE : TERRAIN_EXACT);
 
     unsigned int spawnLoader, cameraLoader;
     world_genChunkLoader(&world, &spawnLoader);
@@ -127,10 +134,12 @@ int main(void) {
     world_updateChunkLoader(&world, spawnLoader, GLM_VEC3_ZERO);
     world_updateChunkLoader(&world, cameraLoader, GLM_VEC3_ZERO);
 
-    world_doChunkLoading(&world);
+    world_loadPendingChunks(&world);
 
     player_t player;
+    world_beginRead(&world);
     player_init(&world, &player);
+    world_endRead(&world);
 
     analytics_t analytics;
     analytics_init(&analytics);
@@ -170,14 +179,18 @@ int main(void) {
                 break;
             }
             atomic_store_explicit(&thData.run, false, memory_order_release);
+            world_wakeChunkLoading(&world);
         }
 
         glfwSwapInterval(1);
         analytics_startFrame(&analytics);
+        // Everything touching chunks this frame sees the same snapshot, and nothing
+        // in it is reclaimed until the read section ends
+        world_beginRead(&world);
         processPlayerInput(window, &camera, &player, &world, analytics.dt);
         processCameraInput(window, &camera);
 
-        world_updateChunkLoader(&world, cameraLoader, camera.eye);
+        world_updateChunkLoaderPrefetch(&world, cameraLoader, camera.eye, player.entity.velocity);
 
         world_processAllEntities(&world, analytics.dt);
         main_thread_free(&world.queues.chunkBufferFreeQueue);
@@ -187,7 +200,12 @@ int main(void) {
         player_attachCamera(&player, &camera);
         camera_update(&camera);
 
-        rendering_updateProjection(postProcessingEnabled, FOV_Y, actual_screen_width, actual_screen_height, CHUNK_LOAD_RADIUS);
+        // Once per frame rather than per eye, so the upload budget covers the whole frame
+        world_remeshChunks(&world, camera.eye);
+        const worldUploadStats_t uploads = world_getUploadStats(&world);
+        analytics_recordUploads(&analytics, uploads.uploaded, uploads.deferred);
+
+        rendering_updateProjection(postProcessingEnabled, FOV_Y, actual_screen_width, actual_screen_height, (float)world_getViewDistance(&world));
         rendering_render(&world, &camera, &player, wireframeView, postProcessingEnabled);
         #ifdef ENABLE_AUDIO
                 world_updateEngine(&world, camera.eye, camera.ruf);
@@ -202,9 +220,18 @@ int main(void) {
         fpsDisplayAcc += analytics.dt;
         if (fpsDisplayAcc > 1.0) {
             LOG_INFO("%.0lf\n", analytics.fps);
+            if (analytics.framesDeferring > 0) {
+                LOG_INFO("Chunk uploads deferred in %zu frames, %zu meshes waiting",
+                         analytics.framesDeferring, analytics.deferredUploads);
+                analytics.framesDeferring = 0;
+            }
             fpsDisplayAcc = 0.0;
         }
 
+        // Ended before swapping, which can block on vsync, so unloaded chunks are
+        // reclaimed promptly
+        world_endRead(&world);
+
         glfwPollEvents();
         glfwSwapBuffers(window);
 
@@ -1,4 +1,5 @@
 #include <cglm/cglm.h>
+#include <string.h>
 #include "math.h"
 #include "noise.h"
 
@@ -85,3 +86,160 @@ float noise_fbm(noise_t *n,
 
     return total / maxAmplitude;
 }
+
+#if defined(__GNUC__) && !defined(NOISE_SCALAR)
+
+/*
+ * The batch functions below evaluate NOISE_LANES points at a time with GCC vector
+ * extensions, which compile to SSE2 or AVX2 on x86 and to NEON on ARM. Every step
+ * mirrors the scalar functions above operation for operation, so the results are
+ * bit-identical to calling them point by point. That relies on no multiply-add
+ * being fused, which is why noise.c is built with -ffp-contract=off.
+ */
+
+#define NOISE_LANES 8
+
+typedef float noiseFloat_t __attribute__((vector_size(NOISE_LANES * sizeof(float))));
+typedef int32_t noiseInt_t __attribute__((vector_size(NOISE_LANES * sizeof(int32_t))));
+typedef uint32_t noiseUint_t __attribute__((vector_size(NOISE_LANES * sizeof(uint32_t))));
+typedef int64_t noiseLong_t __attribute__((vector_size(NOISE_LANES * sizeof(int64_t))));
+typedef uint64_t noiseUlong_t __attribute__((vector_size(NOISE_LANES * sizeof(uint64_t))));
+
+// Builds an AVX2 copy of each batch kernel alongside the baseline one and picks
+// between them when the program loads
+#if defined(__x86_64__) && !defined(NOISE_NO_DISPATCH)
+#define NOISE_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define NOISE_KERNEL
+#endif
+// The helpers pass whole vectors around, so they are always inlined into each copy
+// of a kernel rather than called across the differing vector ABIs of the copies
+#define NOISE_INLINE __attribute__((always_inline))
+
+static inline NOISE_INLINE noiseUlong_t mix64Lanes(const noiseUlong_t x) {
+    noiseUlong_t z = x;
+    z = (z ^ z >> 30) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ z >> 27) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief The lanes of noise_value
+ */
+static inline NOISE_INLINE noiseFloat_t valueLanes(const uint32_t seed, const noiseInt_t x, const noiseInt_t y) {
+    // Multiplies as unsigned so overflow wraps, then sign extends like the int passed to mix64
+    const noiseUint_t h = (noiseUint_t)x * 57u ^ (noiseUint_t)y * 97u;
+    const noiseUlong_t z0 = mix64Lanes((noiseUlong_t)__builtin_convertvector((noiseInt_t)h, noiseLong_t));
+    const noiseUint_t low = __builtin_convertvector(mix64Lanes(z0 ^ seed), noiseUint_t);
+    const noiseInt_t z1 = (noiseInt_t)(low & 0x7FFFFFFFu);
+
+    return 1.0f - (__builtin_convertvector(z1, noiseFloat_t) / 1073741824.f);
+}
+
+static inline NOISE_INLINE noiseFloat_t easeLanes(const noiseFloat_t t) {
+    return t * t * t * (t * (t * 6.f - 15.f) + 10.f);
+}
+
+static inline NOISE_INLINE noiseFloat_t lerpLanes(const noiseFloat_t from, const noiseFloat_t to, const noiseFloat_t t) {
+    return from + t * (to - from);
+}
+
+/**
+ * @brief Rounds down to an integer, like (int)floorf for values that fit in an int
+ */
+static inline NOISE_INLINE noiseInt_t floorLanes(const noiseFloat_t x) {
+    const noiseInt_t truncated = __builtin_convertvector(x, noiseInt_t);
+    // Comparisons give -1 where true, which steps negative non-integers down by one
+    return truncated + (__builtin_convertvector(truncated, noiseFloat_t) > x);
+}
+
+/**
+ * @brief The lanes of noise_smoothValue
+ */
+static inline NOISE_INLINE noiseFloat_t smoothValueLanes(const uint32_t seed, const noiseFloat_t x, const noiseFloat_t y) {
+    const noiseInt_t xInt = floorLanes(x);
+    const noiseInt_t yInt = floorLanes(y);
+    const noiseFloat_t xFrac = easeLanes(x - __builtin_convertvector(xInt, noiseFloat_t));
+    const noiseFloat_t yFrac = easeLanes(y - __builtin_convertvector(yInt, noiseFloat_t));
+
+    const noiseFloat_t v00 = valueLanes(seed, xInt, yInt);
+    const noiseFloat_t v10 = valueLanes(seed, xInt + 1, yInt);
+    const noiseFloat_t v01 = valueLanes(seed, xInt, yInt + 1);
+    const noiseFloat_t v11 = valueLanes(seed, xInt + 1, yInt + 1);
+
+    const noiseFloat_t i1 = lerpLanes(v00, v10, xFrac);
+    const noiseFloat_t i2 = lerpLanes(v01, v11, xFrac);
+    return lerpLanes(i1, i2, yFrac);
+}
+
+/**
+ * @brief Loads up to NOISE_LANES floats, padding with zeros
+ */
+static inline NOISE_INLINE noiseFloat_t loadLanes(const float *src, const size_t n) {
+    noiseFloat_t v = { 0 };
+    memcpy(&v, src, n * sizeof(float));
+    return v;
+}
+
+NOISE_KERNEL
+void noise_smoothValueBatch(const noise_t *n, const float *x, const float *y, const size_t count, float *out) {
+    for (size_t i = 0; i < count; i += NOISE_LANES) {
+        const size_t lanes = count - i < NOISE_LANES ? count - i : NOISE_LANES;
+        const noiseFloat_t v = smoothValueLanes(n->seed, loadLanes(x + i, lanes), loadLanes(y + i, lanes));
+        memcpy(out + i, &v, lanes * sizeof(float));
+    }
+}
+
+NOISE_KERNEL
+void noise_fbmBatch(noise_t *n,
+                    const float *x,
+                    const float *y,
+                    const size_t count,
+                    const int octaves,
+                    const float persistence,
+                    const float baseFrequency,
+                    float *out) {
+    for (size_t i = 0; i < count; i += NOISE_LANES) {
+        const size_t lanes = count - i < NOISE_LANES ? count - i : NOISE_LANES;
+        const noiseFloat_t xs = loadLanes(x + i, lanes);
+        const noiseFloat_t ys = loadLanes(y + i, lanes);
+
+        noiseFloat_t total = { 0 };
+        float frequency = baseFrequency;
+        float amplitude = 1.f;
+        float maxAmplitude = 0.f;
+
+        for (int o = 0; o < octaves; o++) {
+            total += smoothValueLanes(n->seed, xs * frequency, ys * frequency) * amplitude;
+            maxAmplitude += amplitude;
+            amplitude *= persistence;
+            frequency *= 2.f;
+        }
+
+        const noiseFloat_t v = total / maxAmplitude;
+        memcpy(out + i, &v, lanes * sizeof(float));
+    }
+}
+
+#else
+
+void noise_smoothValueBatch(const noise_t *n, const float *x, const float *y, const size_t count, float *out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = noise_smoothValue(n, x[i], y[i]);
+    }
+}
+
+void noise_fbmBatch(noise_t *n,
+                    const float *x,
+                    const float *y,
+                    const size_t count,
+                    const int octaves,
+                    const float persistence,
+                    const float baseFrequency,
+                    float *out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = noise_fbm(n, x[i], y[i], octaves, persistence, baseFrequency);
+    }
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef NOISE_H
 #define NOISE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -91,4 +92,40 @@ float noise_smoothValue(const noise_t *n, float x, float y);
  */
 float noise_fbm(noise_t *n, float x, float y, int octaves, float persistence, float baseFrequency);
 
+/**
+ * @brief Generates smooth value noise at many points at once
+ *
+ * @param n A pointer to a noise object
+ * @param x The first inputs
+ * @param y The second inputs
+ * @param count The number of points
+ * @param out Where to store the count noise values
+ * @note Vectorised where the compiler supports it, and bit-identical to calling
+ *       noise_smoothValue for each point. Inputs must fit in an int once rounded down.
+ */
+void noise_smoothValueBatch(const noise_t *n, const float *x, const float *y, size_t count, float *out);
+
+/**
+ * @brief A fractal brownian motion function evaluated at many points at once
+ *
+ * @param n A pointer to a noise object
+ * @param x The first inputs
+ * @param y The second inputs
+ * @param count The number of points
+ * @param octaves The number of octaves of noise
+ * @param persistence The persistence
+ * @param baseFrequency The base frequency
+ * @param out Where to store the count values
+ * @note Vectorised where the compiler supports it, and bit-identical to calling
+ *       noise_fbm for each point
+ */
+void noise_fbmBatch(noise_t *n,
+                    const float *x,
+                    const float *y,
+                    size_t count,
+                    int octaves,
+                    float persistence,
+                    float baseFrequency,
+                    float *out);
+
 #endif
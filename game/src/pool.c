@@ -0,0 +1,99 @@
+#include <logging.h>
+#include <stdlib.h>
+#include "pool.h"
+
+void pool_init(pool_t *p,
+               const size_t objectSize,
+               const size_t highWater,
+               const pool_callback_t construct,
+               const pool_callback_t reuse,
+               const pool_callback_t destruct) {
+    p->objectSize = objectSize;
+    p->highWater = highWater;
+    p->freeList = NULL;
+    if (highWater > 0) {
+        p->freeList = malloc(highWater * sizeof(void *));
+        if (!p->freeList) {
+            LOG_FATAL("pool_init malloc failed");
+        }
+    }
+    p->construct = construct;
+    p->reuse = reuse;
+    p->destruct = destruct;
+
+    atomic_init(&p->nFree, 0);
+    atomic_init(&p->live, 0);
+    atomic_init(&p->peak, 0);
+}
+
+static void destroyObject(const pool_t *p, void *obj) {
+    if (p->destruct) p->destruct(obj);
+    free(obj);
+}
+
+void *pool_acquire(pool_t *p) {
+    void *obj;
+    const size_t nFree = atomic_load_explicit(&p->nFree, memory_order_relaxed);
+    if (nFree > 0) {
+        obj = p->freeList[nFree - 1];
+        atomic_store_explicit(&p->nFree, nFree - 1, memory_order_relaxed);
+        if (p->reuse) p->reuse(obj);
+    } else {
+        obj = calloc(1, p->objectSize);
+        if (!obj) {
+            LOG_FATAL("pool_acquire calloc failed");
+        }
+        if (p->construct) p->construct(obj);
+    }
+
+    const size_t live = atomic_fetch_add_explicit(&p->live, 1, memory_order_relaxed) + 1;
+    if (live > atomic_load_explicit(&p->peak, memory_order_relaxed)) {
+        atomic_store_explicit(&p->peak, live, memory_order_relaxed);
+    }
+    return obj;
+}
+
+void pool_release(pool_t *p, void *obj) {
+    atomic_fetch_sub_explicit(&p->live, 1, memory_order_relaxed);
+
+    const size_t nFree = atomic_load_explicit(&p->nFree, memory_order_relaxed);
+    if (nFree < p->highWater) {
+        p->freeList[nFree] = obj;
+        atomic_store_explicit(&p->nFree, nFree + 1, memory_order_relaxed);
+    } else {
+        destroyObject(p, obj);
+    }
+}
+
+void pool_setHighWater(pool_t *p, const size_t highWater) {
+    size_t nFree = atomic_load_explicit(&p->nFree, memory_order_relaxed);
+    while (nFree > highWater) {
+        destroyObject(p, p->freeList[--nFree]);
+    }
+    atomic_store_explicit(&p->nFree, nFree, memory_order_relaxed);
+
+    void **freeList = realloc(p->freeList, (highWater > 0 ? highWater : 1) * sizeof(void *));
+    if (!freeList) {
+        LOG_FATAL("pool_setHighWater realloc failed");
+    }
+    p->freeList = freeList;
+    p->highWater = highWater;
+}
+
+poolStats_t pool_getStats(const pool_t *p) {
+    return (poolStats_t){
+        .live = atomic_load_explicit(&p->live, memory_order_relaxed),
+        .free = atomic_load_explicit(&p->nFree, memory_order_relaxed),
+        .peak = atomic_load_explicit(&p->peak, memory_order_relaxed),
+    };
+}
+
+void pool_free(pool_t *p) {
+    const size_t nFree = atomic_load_explicit(&p->nFree, memory_order_relaxed);
+    for (size_t i = 0; i < nFree; i++) {
+        destroyObject(p, p->freeList[i]);
+    }
+    free(p->freeList);
+    p->freeList = NULL;
+    atomic_store_explicit(&p->nFree, 0, memory_order_relaxed);
+}
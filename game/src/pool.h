@@ -0,0 +1,104 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/**
+ * @brief A callback run on a pooled object
+ * @param obj A pointer to the object
+ */
+typedef void (*pool_callback_t)(void *obj);
+
+/**
+ * @brief A snapshot of a pool's statistics
+ */
+typedef struct {
+    /// The number of objects handed out and not yet released
+    size_t live;
+    /// The number of released objects kept for reuse
+    size_t free;
+    /// The highest number of live objects seen
+    size_t peak;
+} poolStats_t;
+
+/**
+ * @brief A pool of fixed-size heap objects that recycles released objects
+ * @note Objects are handed out zeroed when freshly allocated. A recycled object is
+ *       only passed to the reuse callback, so the owner decides which parts of it
+ *       actually need clearing. Released objects beyond the high-water mark are
+ *       returned to the heap. Acquiring and releasing must happen on a single
+ *       thread, but the statistics can be read from any thread.
+ */
+typedef struct {
+    /// The size of each object in bytes
+    size_t objectSize;
+    /// The maximum number of released objects kept for reuse
+    size_t highWater;
+    /// The heap-allocated stack of released objects, with space for highWater entries
+    void **freeList;
+    /// Called after a fresh object is allocated, may be NULL
+    pool_callback_t construct;
+    /// Called when a released object is handed out again, may be NULL
+    pool_callback_t reuse;
+    /// Called before an object is returned to the heap, may be NULL
+    pool_callback_t destruct;
+
+    atomic_size_t nFree;
+    atomic_size_t live;
+    atomic_size_t peak;
+} pool_t;
+
+/**
+ * @brief Initialises a pool
+ * @param p A pointer to a pool
+ * @param objectSize The size of each object in bytes
+ * @param highWater The maximum number of released objects to keep for reuse
+ * @param construct Called after a fresh object is allocated, may be NULL
+ * @param reuse Called when a released object is handed out again, may be NULL
+ * @param destruct Called before an object is returned to the heap, may be NULL
+ */
+void pool_init(pool_t *p,
+               size_t objectSize,
+               size_t highWater,
+               pool_callback_t construct,
+               pool_callback_t reuse,
+               pool_callback_t destruct);
+
+/**
+ * @brief Takes an object from the pool, allocating one if none are free
+ * @param p A pointer to a pool
+ * @return A pointer to the object
+ */
+void *pool_acquire(pool_t *p);
+
+/**
+ * @brief Returns an object to the pool
+ * @param p A pointer to a pool
+ * @param obj A pointer to an object acquired from the same pool
+ */
+void pool_release(pool_t *p, void *obj);
+
+/**
+ * @brief Changes the high-water mark of a pool
+ * @param p A pointer to a pool
+ * @param highWater The maximum number of released objects to keep for reuse
+ * @note Free objects above the new mark are returned to the heap immediately
+ */
+void pool_setHighWater(pool_t *p, size_t highWater);
+
+/**
+ * @brief Reads the statistics of a pool
+ * @param p A pointer to a pool
+ * @return The statistics
+ */
+poolStats_t pool_getStats(const pool_t *p);
+
+/**
+ * @brief Frees a pool and every free object in it
+ * @param p A pointer to a pool
+ * @note Objects that are still live are not freed
+ */
+void pool_free(pool_t *p);
+
+#endif
@@ -2,13 +2,11 @@
 #include <string.h>
 #include "queue.h"
 
+// the buffer is only allocated on the first push, as most chunks never queue any light
 void queue_initQueue(lightQueue_t *queue) {
     queue->size = 0;
-    queue->capacity = 16;
-    queue->data = malloc(queue->capacity * sizeof(lightQueueItem_t));
-    if (!queue->data) {
-        LOG_FATAL("queue_init malloc failed");
-    }
+    queue->capacity = 0;
+    queue->data = NULL;
     queue->head = 0;
     queue->tail = 0;
 }
@@ -18,9 +16,16 @@ void queue_freeQueue(lightQueue_t *queue) {
     queue->data = NULL;
 }
 
+// empties the queue, keeping its buffer
+void queue_clear(lightQueue_t *queue) {
+    queue->size = 0;
+    queue->head = 0;
+    queue->tail = 0;
+}
+
 static void queue_resize(lightQueue_t *queue) {
     size_t oldCapacity = queue->capacity;
-    queue->capacity *= 2;
+    queue->capacity = oldCapacity ? oldCapacity * 2 : 16;
     lightQueueItem_t *newQueue = malloc(queue->capacity * sizeof(lightQueueItem_t));
     if (!newQueue) {
         LOG_FATAL("queue_resize malloc failed");
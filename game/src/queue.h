@@ -24,6 +24,7 @@ typedef struct {
 
 extern void queue_initQueue(lightQueue_t *queue);
 extern void queue_freeQueue(lightQueue_t *queue);
+extern void queue_clear(lightQueue_t *queue);
 extern void queue_push(lightQueue_t *queue, lightQueueItem_t item);
 extern lightQueueItem_t queue_pop(lightQueue_t *queue);
 extern int queue_tests();
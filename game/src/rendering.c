@@ -99,8 +99,8 @@ static void shader_init(void) {
 
 static void fog_init() {
     glUseProgram(chunkShader);
-    glUniform1f(glGetUniformLocation(chunkShader, "fogStart"), FOG_START);
-    glUniform1f(glGetUniformLocation(chunkShader, "fogEnd"), FOG_END);
+    glUniform1f(glGetUniformLocation(chunkShader, "fogStart"), FOG_START(CHUNK_LOAD_RADIUS));
+    glUniform1f(glGetUniformLocation(chunkShader, "fogEnd"), FOG_END(CHUNK_LOAD_RADIUS));
     glUseProgram(0);
 }
 
@@ -126,13 +126,14 @@ static void render_world(world_t *world, camera_t *camera) {
     glBindTexture(GL_TEXTURE_2D, blockAtlasTexture);
     glUniform1i(glGetUniformLocation(chunkShader, "uTextureAtlas"), 0);
     glUniformMatrix4fv(glGetUniformLocation(chunkShader, "projection"), 1, false, (const GLfloat *)projection);
-    glUniform1f(glGetUniformLocation(chunkShader, "fogStart"), FOG_START);
-    glUniform1f(glGetUniformLocation(chunkShader, "fogEnd"), FOG_END);
+    // The view distance can change at runtime, so the fog follows it every frame
+    const int viewDistance = world_getViewDistance(world);
+    glUniform1f(glGetUniformLocation(chunkShader, "fogStart"), FOG_START(viewDistance));
+    glUniform1f(glGetUniformLocation(chunkShader, "fogEnd"), FOG_END(viewDistance));
 
     camera_setView(camera, chunkShader);
 
-    world_remeshChunks(world);
-
+    world_setLoadView(world, camera, projection);
     world_draw(world, chunkShaderModelLocation, camera, projection);
     world_drawHighlight(world, chunkShaderModelLocation);
     glUseProgram(0);
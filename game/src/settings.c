@@ -0,0 +1,159 @@
+#include <errno.h>
+#include <logging.h>
+#include <stdlib.h>
+#include <string.h>
+#include "jobpool.h"
+#include "settings.h"
+#include "world.h"
+
+#define VIEW_DISTANCE_ENV "VOXEL_VIEW_DISTANCE"
+#define MEMORY_BUDGET_ENV "VOXEL_MEMORY_BUDGET_MB"
+#define GEN_THREADS_ENV "VOXEL_GEN_THREADS"
+#define LOD_DISTANCE_ENV "VOXEL_LOD_DISTANCE"
+#define TERRAIN_ENV "VOXEL_TERRAIN"
+#define VIEW_DISTANCE_ARG "--view-distance"
+#define MEMORY_BUDGET_ARG "--memory-budget"
+#define GEN_THREADS_ARG "--gen-threads"
+#define LOD_DISTANCE_ARG "--lod-distance"
+#define TERRAIN_ARG "--terrain"
+#define MAX_GEN_THREADS 64
+
+/**
+ * @brief Parses a whole string as a non-negative integer
+ * @param str The string
+ * @param result A pointer to where to store the integer
+ * @return Whether the string was a valid integer
+ */
+static bool parseCount(const char *str, long *result) {
+    char *end;
+    errno = 0;
+    const long value = strtol(str, &end, 10);
+    if (errno != 0 || end == str || *end != '\0' || value < 0) {
+        return false;
+    }
+    *result = value;
+    return true;
+}
+
+/**
+ * @brief Sets the view distance from a string
+ * @param s A pointer to the settings
+ * @param str The view distance in chunks
+ * @param source Where the string came from, for logging
+ */
+static void setViewDistance(settings_t *s, const char *str, const char *source) {
+    long value;
+    if (!parseCount(str, &value) || value < MIN_VIEW_DISTANCE || value > MAX_VIEW_DISTANCE) {
+        LOG_WARN("Ignoring %s view distance \"%s\", it must be from %d to %d chunks",
+                 source, str, MIN_VIEW_DISTANCE, MAX_VIEW_DISTANCE);
+        return;
+    }
+    s->viewDistance = (int)value;
+}
+
+/**
+ * @brief Sets the memory budget from a string
+ * @param s A pointer to the settings
+ * @param str The budget in MiB, or 0 for no limit
+ * @param source Where the string came from, for logging
+ */
+static void setMemoryBudget(settings_t *s, const char *str, const char *source) {
+    long value;
+    if (!parseCount(str, &value)) {
+        LOG_WARN("Ignoring %s memory budget \"%s\", it must be a number of MiB", source, str);
+        return;
+    }
+    s->memoryBudget = (size_t)value * 1024 * 1024;
+}
+
+/**
+ * @brief Sets the number of generation threads from a string
+ * @param s A pointer to the settings
+ * @param str The number of threads
+ * @param source Where the string came from, for logging
+ */
+static void setGenerationThreads(settings_t *s, const char *str, const char *source) {
+    long value;
+    if (!parseCount(str, &value) || value < 1 || value > MAX_GEN_THREADS) {
+        LOG_WARN("Ignoring %s thread count \"%s\", it must be from 1 to %d", source, str, MAX_GEN_THREADS);
+        return;
+    }
+    s->generationThreads = (int)value;
+}
+
+/**
+ * @brief Sets the level of detail distance from a string
+ * @param s A pointer to the settings
+ * @param str The distance in chunks, or 0 for full detail everywhere
+ * @param source Where the string came from, for logging
+ */
+static void setLodDistance(settings_t *s, const char *str, const char *source) {
+    long value;
+    if (!parseCount(str, &value) || value > MAX_VIEW_DISTANCE) {
+        LOG_WARN("Ignoring %s LOD distance \"%s\", it must be from 0 to %d chunks",
+                 source, str, MAX_VIEW_DISTANCE);
+        return;
+    }
+    s->lodDistance = (int)value;
+}
+
+/**
+ * @brief Sets the terrain sampling from a string
+ * @param s A pointer to the settings
+ * @param str Either "exact" or "coarse"
+ * @param source Where the string came from, for logging
+ */
+static void setTerrain(settings_t *s, const char *str, const char *source) {
+    if (strcmp(str, "exact") == 0) {
+        s->coarseTerrain = false;
+    } else if (strcmp(str, "coarse") == 0) {
+        s->coarseTerrain = true;
+    } else {
+        LOG_WARN("Ignoring %s terrain \"%s\", it must be exact or coarse", source, str);
+    }
+}
+
+void settings_load(settings_t *s, const int argc, char **argv) {
+    s->viewDistance = CHUNK_LOAD_RADIUS;
+    s->memoryBudget = 0;
+    s->generationThreads = jobPool_defaultThreads();
+    s->lodDistance = DEFAULT_LOD_DISTANCE;
+    s->coarseTerrain = false;
+
+    const char *env = getenv(VIEW_DISTANCE_ENV);
+    if (env) {
+        setViewDistance(s, env, VIEW_DISTANCE_ENV);
+    }
+    env = getenv(MEMORY_BUDGET_ENV);
+    if (env) {
+        setMemoryBudget(s, env, MEMORY_BUDGET_ENV);
+    }
+    env = getenv(GEN_THREADS_ENV);
+    if (env) {
+        setGenerationThreads(s, env, GEN_THREADS_ENV);
+    }
+    env = getenv(LOD_DISTANCE_ENV);
+    if (env) {
+        setLodDistance(s, env, LOD_DISTANCE_ENV);
+    }
+    env = getenv(TERRAIN_ENV);
+    if (env) {
+        setTerrain(s, env, TERRAIN_ENV);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], VIEW_DISTANCE_ARG) == 0 && i + 1 < argc) {
+            setViewDistance(s, argv[++i], VIEW_DISTANCE_ARG);
+        } else if (strcmp(argv[i], MEMORY_BUDGET_ARG) == 0 && i + 1 < argc) {
+            setMemoryBudget(s, argv[++i], MEMORY_BUDGET_ARG);
+        } else if (strcmp(argv[i], GEN_THREADS_ARG) == 0 && i + 1 < argc) {
+            setGenerationThreads(s, argv[++i], GEN_THREADS_ARG);
+        } else if (strcmp(argv[i], LOD_DISTANCE_ARG) == 0 && i + 1 < argc) {
+            setLodDistance(s, argv[++i], LOD_DISTANCE_ARG);
+        } else if (strcmp(argv[i], TERRAIN_ARG) == 0 && i + 1 < argc) {
+            setTerrain(s, argv[++i], TERRAIN_ARG);
+        } else {
+            LOG_WARN("Ignoring unknown argument \"%s\"", argv[i]);
+        }
+    }
+}
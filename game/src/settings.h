@@ -0,0 +1,36 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Settings chosen at launch rather than at compile time
+ */
+typedef struct {
+    /// The view distance in chunks
+    int viewDistance;
+    /// The most bytes of chunks and meshes to keep resident, or 0 for no limit
+    size_t memoryBudget;
+    /// The number of threads generating and meshing chunks
+    int generationThreads;
+    /// The distance in chunks beyond which chunks are meshed at lower detail, or 0 for never
+    int lodDistance;
+    /// Whether the terrain is sampled on a coarse lattice and interpolated, rather than exactly
+    bool coarseTerrain;
+} settings_t;
+
+/**
+ * @brief Loads the settings from the environment and the command line
+ * @param s A pointer to the settings to fill in
+ * @param argc The number of command line arguments
+ * @param argv The command line arguments
+ * @note Reads VOXEL_VIEW_DISTANCE, VOXEL_MEMORY_BUDGET_MB, VOXEL_GEN_THREADS,
+ *       VOXEL_LOD_DISTANCE and VOXEL_TERRAIN first, then --view-distance <chunks>,
+ *       --memory-budget <MiB>, --gen-threads <threads>, --lod-distance <chunks> and
+ *       --terrain <exact|coarse>, which take precedence.
+ *       Anything unrecognised or out of range is logged and ignored.
+ */
+void settings_load(settings_t *s, int argc, char **argv);
+
+#endif
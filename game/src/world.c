@@ -1,9 +1,10 @@
-#include <uthash.h>
 #include <cglm/cglm.h>
 #include <errno.h>
+#include <limits.h>
 #include <logging.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <time.h>
 #include "world.h"
 #include "chunk.h"
 #include "entity.h"
@@ -17,28 +18,17 @@
 #define BLOCK_DERENDER_DISTANCE 50.f
 
 /**
- * @brief Key for hash table
- */
-typedef struct {
-    int x, y, z;
-} clusterKey_t;
-
-
-/**
- * @brief A cluster and also hashmap
+ * @brief A cluster of chunks, stored in the world's cluster index
  * @note A cluster is essentially a group of adjacent chunks
  */
-typedef struct _s_cluster {
-    /// The key to the hashmap entry
+typedef struct {
+    /// The key of the cluster in the cluster index
     clusterKey_t key;
 
     /// The heap-allocated array of chunk values in the cluster
     chunkValue_t *cells;
     /// The number of chunks loaded in the clusters
     size_t n;
-
-    /// Hash table marker
-    UT_hash_handle hh;
 } cluster_t;
 
 /**
@@ -52,18 +42,15 @@ typedef struct _s_cluster {
  * @return A pointer to the cluster or null
  */
 static cluster_t *clusterGet(world_t *w, const int cx, const int cy, const int cz, bool create, size_t *offset) {
-    cluster_t *clusterPtr;
-
     // Transforming the chunk coordinates to cluster coordinates by
-    // removing the 2 LSBs
-    clusterKey_t k = {
+    // removing the LOG_C_T LSBs
+    const clusterKey_t k = {
         cx >> LOG_C_T,
         cy >> LOG_C_T,
         cz >> LOG_C_T,
     };
 
-    // Puts the result of the hash find inside clusterPtr
-    HASH_FIND(hh, w->clusterTable, &k, sizeof(clusterKey_t), clusterPtr);
+    cluster_t *clusterPtr = clusterIndex_get(&w->clusters, k);
 
     // Creates the cluster if it doesn't exist, and create is set
     if (clusterPtr) {
@@ -72,11 +59,11 @@ static cluster_t *clusterGet(world_t *w, const int cx, const int cy, const int c
 
         // Allocate space for the cluster
         clusterPtr = (cluster_t *)calloc(1, sizeof(cluster_t));
-        // Allocate space for the cells array inside the cluster
-        clusterPtr->cells = calloc(C_T * C_T * C_T, sizeof(chunkValue_t));
+        // Take a cells array from the pool, every cell of which has a NULL chunk
+        clusterPtr->cells = pool_acquire(&w->pools.clusterCells);
         clusterPtr->key = k;
 
-        HASH_ADD(hh, w->clusterTable, key, sizeof(clusterKey_t), clusterPtr);
+        clusterIndex_insert(&w->clusters, k, clusterPtr);
     }
     // The direct access index of the chunk into the cluster
     *offset =
@@ -87,16 +74,117 @@ static cluster_t *clusterGet(world_t *w, const int cx, const int cy, const int c
 }
 
 static void world_decorateChunk(world_t *w, chunkValue_t *cv);
+static void linkNeighbours(world_t *w, chunk_t *c);
+
+/**
+ * @brief Gets the time on the monotonic clock
+ * @return The time in seconds
+ */
+static double monotonicTime(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Decorates, lights and links a chunk whose terrain has been generated, which
+ *        makes it fully loaded
+ * @param w A pointer to a world
+ * @param cv A pointer to the chunk's cell
+ */
+static void finishChunk(world_t *w, chunkValue_t *cv) {
+    world_decorateChunk(w, cv);
+    chunk_initSun(cv->chunk);
+    linkNeighbours(w, cv->chunk);
+    w->snapshotDirty = true;
+    cv->ll = LL_TOTAL;
+}
 
 chunk_t *world_getFullyLoadedChunk(world_t *w, const int cx, const int cy, const int cz) {
     size_t offset;
 
-    const cluster_t *cluster = clusterGet(w, cx, cy, cz, true, &offset);
+    const cluster_t *cluster = clusterGet(w, cx, cy, cz, false, &offset);
+    if (!cluster) return NULL;
     const chunkValue_t *cv = &cluster->cells[offset];
 
     return cv->chunk && cv->ll > LL_PARTIAL ? cv->chunk : NULL;
 }
 
+/**
+ * @brief Generates a chunk's terrain unless a decoration already needed it, and counts
+ *        chunks that skipped generating each block
+ * @param w A pointer to a world
+ * @param c A pointer to the chunk
+ * @param column A pointer to the chunk's column
+ * @note Called from the generation jobs as well as the chunk loading thread
+ */
+static void generateChunk(world_t *w, chunk_t *c, const chunkColumn_t *column) {
+    if (c->generated) return;
+    switch (chunk_generate(c, column)) {
+        case GEN_AIR:
+            atomic_fetch_add_explicit(&w->loadStats.airChunks, 1, memory_order_relaxed);
+            break;
+        case GEN_STONE:
+            atomic_fetch_add_explicit(&w->loadStats.stoneChunks, 1, memory_order_relaxed);
+            break;
+        case GEN_FULL:
+            break;
+    }
+}
+
+/**
+ * @brief Hands a palette buffer replaced by a widen to the world's epoch, since the
+ *        render thread may still be reading it
+ * @param ctx A pointer to a world
+ * @param data The palette buffer
+ */
+static void retirePaletteData(void *ctx, void *data) {
+    world_t *w = ctx;
+    epoch_retire(&w->epoch, data, blockPalette_freeRetired, NULL);
+}
+
+/**
+ * @brief Links a newly fully loaded chunk with its fully loaded neighbours, and
+ *        flags them for re-meshing.
+ * @param w A pointer to a world
+ * @param c A pointer to the chunk
+ */
+static void linkNeighbours(world_t *w, chunk_t *c) {
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dz = -1; dz <= 1; dz++) {
+                if (dx == 0 && dy == 0 && dz == 0) {
+                    chunk_neighbour(c, 0, 0, 0) = c;
+                    continue;
+                }
+                chunk_t *neighbour = world_getFullyLoadedChunk(w, c->cx + dx, c->cy + dy, c->cz + dz);
+                chunk_neighbour(c, dx, dy, dz) = neighbour;
+                if (neighbour) {
+                    chunk_neighbour(neighbour, -dx, -dy, -dz) = c;
+                    neighbour->tainted = true;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Removes a chunk from its neighbours' neighbour tables.
+ * @param c A pointer to the chunk
+ */
+static void unlinkNeighbours(chunk_t *c) {
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dz = -1; dz <= 1; dz++) {
+                chunk_t *neighbour = chunk_neighbour(c, dx, dy, dz);
+                if (neighbour && neighbour != c) {
+                    chunk_neighbour(neighbour, -dx, -dy, -dz) = NULL;
+                }
+            }
+        }
+    }
+}
+
 /**
  * @brief Loads a chunk.
  * @param w A pointer to a world
@@ -119,7 +207,7 @@ chunkValue_t *world_loadChunk(world_t *w,
     chunkValue_t *cv = &cluster->cells[offset];
 
     if (!cv->chunk) {
-        cv->chunk = (chunk_t *)calloc(1, sizeof(chunk_t));
+        cv->chunk = pool_acquire(&w->pools.chunks);
 
         rng_t chunkRng;
         rng_init(&chunkRng, w->seed ^
@@ -128,33 +216,22 @@ chunkValue_t *world_loadChunk(world_t *w,
                             ((uint64_t)cz << 48));
 
         chunk_init(cv->chunk, chunkRng, w->noise, cx, cy, cz);
+        cv->chunk->blocks.retire = retirePaletteData;
+        cv->chunk->blocks.retireCtx = w;
+        blockPalette_setStats(&cv->chunk->blocks, &w->paletteStats);
         cv->ll = LL_INIT;
         cv->loadData.reload = REL_TOMBSTONE;
         cv->loadData.nChildren = 0;
+        cv->loadData.nParents = 0;
+        cv->loadData.nLoaders = 0;
 
         cluster->n++;
     }
 
     if (ll > cv->ll) {
         if (ll > LL_PARTIAL) {
-            chunk_generate(cv->chunk);
-            world_decorateChunk(w, cv);
-            chunk_initSun(cv->chunk);
-            // flag all neighbouring chunks for re-meshing
-            int offsets[] = { -1, 0, 1 };
-            for (int i = 0; i < 3; i++) {
-                for (int j = 0; j < 3; j++) {
-                    for (int k = 0; k < 3; k++) {
-                        chunk_t *neighbour = world_getFullyLoadedChunk(w,
-                            cv->chunk->cx + offsets[i],
-                            cv->chunk->cy + offsets[j],
-                            cv->chunk->cz + offsets[k]);
-                        if (neighbour) {
-                            neighbour->tainted = true;
-                        }
-                    }
-                }
-            }
+            generateChunk(w, cv->chunk, columnCache_acquire(&w->columns, cx, cz));
+            finishChunk(w, cv);
         }
         cv->ll = ll;
     }
@@ -164,20 +241,29 @@ chunkValue_t *world_loadChunk(world_t *w,
     return cv;
 }
 
-static bool getBlockAddr(world_t *w, const int x, const int y, const int z, block_t **block, chunk_t **chunk) {
+/**
+ * @brief Finds the chunk holding a block in the render thread's snapshot.
+ * @param w A pointer to a world
+ * @param x Block x
+ * @param y Block y
+ * @param z Block z
+ * @param chunk An out parameter for the chunk
+ * @param blockPos An out parameter for the block's position within the chunk
+ * @return Whether the chunk is loaded
+ */
+static bool getBlockChunk(const world_t *w, const int x, const int y, const int z, chunk_t **chunk, ivec3 blockPos) {
     const int cx = x >> 4;
     const int cy = y >> 4;
     const int cz = z >> 4;
 
-    size_t offset;
-    cluster_t *cluster = clusterGet(w, cx, cy, cz, false, &offset);
-    if (!cluster) return false;
-
-    const chunkValue_t cv = cluster->cells[offset];
-    if (!cv.chunk) return false;
+    if (!w->readSnapshot) return false;
+    chunk_t *c = chunkSnapshot_get(w->readSnapshot, cx, cy, cz);
+    if (!c) return false;
 
-    *chunk = cv.chunk;
-    *block = &cv.chunk->blocks[x - (cx << 4)][y - (cy << 4)][z - (cz << 4)];
+    *chunk = c;
+    blockPos[0] = x - (cx << 4);
+    blockPos[1] = y - (cy << 4);
+    blockPos[2] = z - (cz << 4);
 
     return true;
 }
@@ -198,8 +284,15 @@ static void highlightInit(world_t *w) {
 
 void world_init(world_t *w, const uint64_t seed) {
     memset(w, 0, sizeof(world_t));
-    w->clusterTable = NULL;
+    clusterIndex_init(&w->clusters, MAX_CHUNKS);
+    pool_init(&w->pools.chunks, sizeof(chunk_t), CHUNK_POOL_HIGH_WATER,
+              chunk_poolConstruct, chunk_poolReuse, chunk_poolDestruct);
+    pool_init(&w->pools.clusterCells, C_T * C_T * C_T * sizeof(chunkValue_t), CLUSTER_POOL_HIGH_WATER,
+              NULL, NULL, NULL);
+    columnCache_init(&w->columns, &w->noise);
+    #ifndef WORLD_HEADLESS
     highlightInit(w);
+    #endif
 
     w->numEntities = 0;
     w->oldestItem = 0;
@@ -211,6 +304,39 @@ void world_init(world_t *w, const uint64_t seed) {
     w->noise.seed = (uint32_t)rng_ull(&w->worldRng);
 
     spscRing_init(&w->queues.chunkBufferFreeQueue, 1024);
+    spscRing_init(&w->queues.editQueue, WORLD_EDIT_QUEUE_SIZE);
+    spscRing_init(&w->queues.editResultQueue, WORLD_EDIT_QUEUE_SIZE);
+    spscRing_init(&w->queues.meshQueue, MESH_QUEUE_SIZE);
+    w->meshTasks.items = NULL;
+    w->meshTasks.capacity = 0;
+    atomic_init(&w->meshesInFlight, 0);
+    atomic_init(&w->meshQueueFull, false);
+    w->uploads.items = NULL;
+    w->uploads.n = 0;
+    w->uploads.capacity = 0;
+    w->lastEdit.valid = false;
+    w->uploadStats = (worldUploadStats_t){ 0 };
+    w->snapshotSequence = 0;
+    epoch_init(&w->epoch);
+    atomic_init(&w->snapshot, chunkSnapshot_create(0));
+    atomic_init(&w->targetViewDistance, CHUNK_LOAD_RADIUS);
+    atomic_init(&w->viewDistance, CHUNK_LOAD_RADIUS);
+    atomic_init(&w->memoryBudget, 0);
+    atomic_init(&w->lodDistance, DEFAULT_LOD_DISTANCE);
+    w->meshLodDistance = DEFAULT_LOD_DISTANCE;
+    atomic_init(&w->meshBytes, 0);
+    blockPalette_initStats(&w->paletteStats);
+    atomic_init(&w->reclaimPending, false);
+    jobPool_init(&w->jobs, 1);
+    loadQueue_init(&w->loadQueue);
+    atomic_init(&w->pendingChunks, 0);
+    pthread_mutex_init(&w->view.lock, NULL);
+    w->startTime = monotonicTime();
+    atomic_init(&w->firstVisibleTime, -1.0);
+    pthread_mutex_init(&w->wake.lock, NULL);
+    pthread_cond_init(&w->wake.cond, NULL);
+    // The first pass has to run to load anything at all
+    w->wake.pending = true;
 
     #ifdef ENABLE_AUDIO
     if (ma_engine_init(NULL, &w->engine) != MA_SUCCESS) {
@@ -220,187 +346,1244 @@ void world_init(world_t *w, const uint64_t seed) {
     #endif
 }
 
+worldMemoryStats_t world_getMemoryStats(const world_t *w) {
+    worldMemoryStats_t stats;
+    stats.chunks = pool_getStats(&w->pools.chunks);
+    stats.clusterCells = pool_getStats(&w->pools.clusterCells);
+    stats.columns = pool_getStats(&w->columns.pool);
+    stats.blockBytes = blockPalette_statsBytes(&w->paletteStats);
+    // Chunks waiting in the pool are always emptied to uniform air by chunk_free
+    const size_t uniform = blockPalette_statsUniform(&w->paletteStats);
+    stats.uniformChunks = uniform > stats.chunks.free ? uniform - stats.chunks.free : 0;
+    stats.residentBytes = (stats.chunks.live + stats.chunks.free) * w->pools.chunks.objectSize +
+                          (stats.clusterCells.live + stats.clusterCells.free) * w->pools.clusterCells.objectSize +
+                          (stats.columns.live + stats.columns.free) * w->columns.pool.objectSize +
+                          stats.blockBytes;
+    stats.meshBytes = atomic_load_explicit(&w->meshBytes, memory_order_relaxed);
+    stats.budgetedBytes = stats.chunks.live * w->pools.chunks.objectSize +
+                          stats.clusterCells.live * w->pools.clusterCells.objectSize +
+                          stats.blockBytes + stats.meshBytes;
+    return stats;
+}
+
+worldPassTimes_t world_getPassTimes(const world_t *w) {
+    return w->passTimes;
+}
+
+worldLoadStats_t world_getLoadStats(const world_t *w) {
+    return (worldLoadStats_t){
+        .generated = atomic_load_explicit(&w->loadStats.generated, memory_order_relaxed),
+        .retained = atomic_load_explicit(&w->loadStats.retained, memory_order_relaxed),
+        .regenerationsAvoided = atomic_load_explicit(&w->loadStats.regenerationsAvoided, memory_order_relaxed),
+        .airChunks = atomic_load_explicit(&w->loadStats.airChunks, memory_order_relaxed),
+        .stoneChunks = atomic_load_explicit(&w->loadStats.stoneChunks, memory_order_relaxed),
+    };
+}
+
+void world_setPoolHighWater(world_t *w, const size_t chunks, const size_t clusterCells) {
+    pool_setHighWater(&w->pools.chunks, chunks);
+    pool_setHighWater(&w->pools.clusterCells, clusterCells);
+}
+
+void world_setViewDistance(world_t *w, const int distance) {
+    atomic_store_explicit(&w->targetViewDistance, glm_imin(glm_imax(distance, MIN_VIEW_DISTANCE), MAX_VIEW_DISTANCE),
+                          memory_order_relaxed);
+    world_wakeChunkLoading(w);
+}
+
+void world_setLodDistance(world_t *w, const int distance) {
+    atomic_store_explicit(&w->lodDistance, glm_imin(glm_imax(distance, 0), MAX_VIEW_DISTANCE), memory_order_relaxed);
+    world_wakeChunkLoading(w);
+}
+
+int world_getViewDistance(const world_t *w) {
+    return atomic_load_explicit(&w->viewDistance, memory_order_relaxed);
+}
+
+void world_setMemoryBudget(world_t *w, const size_t bytes) {
+    atomic_store_explicit(&w->memoryBudget, bytes, memory_order_relaxed);
+    world_wakeChunkLoading(w);
+}
+
+void world_beginRead(world_t *w) {
+    epoch_enter(&w->epoch);
+    // Sequentially consistent, so a snapshot retired before the epoch was entered
+    // can't be the one loaded here
+    w->readSnapshot = atomic_load(&w->snapshot);
+}
+
+void world_endRead(world_t *w) {
+    w->readSnapshot = NULL;
+    epoch_exit(&w->epoch);
+    // Whatever was retired while the snapshot was held can now be reclaimed
+    if (atomic_load_explicit(&w->reclaimPending, memory_order_relaxed)) {
+        world_wakeChunkLoading(w);
+    }
+}
+
 vec3 chunkBounds = {15.f, 15.f, 15.f};
 
-static bool completelyOutsidePlane(const double plane[4], const chunk_t *chunk) {
+static bool completelyOutsidePlane(const double plane[4], const int cx, const int cy, const int cz) {
     const double testPoint[3] = {
-        (chunk->cx << 4) + (plane[0] > 0 ? 16 : 0),
-        (chunk->cy << 4) + (plane[1] > 0 ? 16 : 0),
-        (chunk->cz << 4) + (plane[2] > 0 ? 16 : 0),
+        (cx << 4) + (plane[0] > 0 ? 16 : 0),
+        (cy << 4) + (plane[1] > 0 ? 16 : 0),
+        (cz << 4) + (plane[2] > 0 ? 16 : 0),
     };
     const double dot = testPoint[0] * plane[0] + testPoint[1] * plane[1] + testPoint[2] * plane[2];
     return dot < -plane[3];
 }
 
-// Note - we assume lookVector is normalised
-static bool shouldRender(camera_t *cam, const chunk_t *chunk, double planes[6][4]) {
-    for (int i = 0; i < 6; i++) {
-        if (completelyOutsidePlane(planes[i], chunk)) {
-            return false;
+/**
+ * @brief Checks whether any of a chunk may be inside a frustum
+ * @param planes The frustum planes
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ * @return Whether the chunk isn't completely outside any of the planes
+ */
+static bool chunkInFrustum(double planes[6][4], const int cx, const int cy, const int cz) {
+    for (int i = 0; i < 6; i++) {
+        if (completelyOutsidePlane(planes[i], cx, cy, cz)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Note - we assume lookVector is normalised
+static bool shouldRender(camera_t *cam, const chunk_t *chunk, double planes[6][4]) {
+    return chunkInFrustum(planes, chunk->cx, chunk->cy, chunk->cz);
+}
+
+static void calculatePlanes(camera_t *cam, mat4 projection, double res[6][4]) {
+    mat4 view;
+    camera_createView(cam, view);
+    mat4 projview;
+    glm_mat4_mul(projection, view, projview);
+
+    for (int i = 0; i < 3; i++) {
+        res[i*2][0] = projview[0][3] + projview[0][i];
+        res[i*2][1] = projview[1][3] + projview[1][i];
+        res[i*2][2] = projview[2][3] + projview[2][i];
+        res[i*2][3] = projview[3][3] + projview[3][i];
+
+        res[i*2+1][0] = projview[0][3] - projview[0][i];
+        res[i*2+1][1] = projview[1][3] - projview[1][i];
+        res[i*2+1][2] = projview[2][3] - projview[2][i];
+        res[i*2+1][3] = projview[3][3] - projview[3][i];
+    }
+}
+
+void world_setLoadView(world_t *w, camera_t *cam, mat4 projection) {
+    double planes[6][4];
+    calculatePlanes(cam, projection, planes);
+
+    pthread_mutex_lock(&w->view.lock);
+    // The loader only reprioritises when the version moves, so a still camera costs nothing
+    if (!w->view.valid || memcmp(planes, w->view.planes, sizeof(planes)) != 0) {
+        memcpy(w->view.planes, planes, sizeof(planes));
+        w->view.valid = true;
+        w->view.version++;
+    }
+    pthread_mutex_unlock(&w->view.lock);
+}
+
+/**
+ * @brief A mesh waiting on the render thread to be uploaded
+ */
+typedef struct pendingUpload_t {
+    chunkMesh_t *mesh;
+    /// Lower is uploaded first
+    float priority;
+} pendingUpload_t;
+
+/**
+ * @brief Adds a mesh taken from the mesh queue to the pending uploads
+ * @param w A pointer to a world
+ * @param m A pointer to the mesh
+ * @return Whether the mesh replaced an older one of the same chunk, which is freed
+ */
+static bool addPendingUpload(world_t *w, chunkMesh_t *m) {
+    for (size_t i = 0; i < w->uploads.n; i++) {
+        chunkMesh_t *old = w->uploads.items[i].mesh;
+        if (old->chunk == m->chunk && old->cx == m->cx && old->cy == m->cy && old->cz == m->cz) {
+            chunkMesh_free(old);
+            w->uploads.items[i].mesh = m;
+            return true;
+        }
+    }
+    if (w->uploads.n == w->uploads.capacity) {
+        const size_t capacity = w->uploads.capacity ? w->uploads.capacity * 2 : 64;
+        pendingUpload_t *items = realloc(w->uploads.items, capacity * sizeof(pendingUpload_t));
+        if (!items) {
+            LOG_FATAL("Pending upload realloc failed");
+        }
+        w->uploads.items = items;
+        w->uploads.capacity = capacity;
+    }
+    w->uploads.items[w->uploads.n++] = (pendingUpload_t){ .mesh = m, .priority = 0.f };
+    return false;
+}
+
+/**
+ * @brief Gives a pending upload its priority, the squared distance in chunks from
+ *        the camera, or -1 next to the latest block edit
+ * @param w A pointer to a world
+ * @param m A pointer to the mesh
+ * @param cx The chunk x coordinate of the camera
+ * @param cy The chunk y coordinate of the camera
+ * @param cz The chunk z coordinate of the camera
+ * @return The priority
+ */
+static float uploadPriority(const world_t *w, const chunkMesh_t *m, const int cx, const int cy, const int cz) {
+    // An edit on a chunk's face remeshes the neighbour too, so both show the change together
+    if (w->lastEdit.valid && abs(m->cx - w->lastEdit.cx) <= 1 && abs(m->cy - w->lastEdit.cy) <= 1 &&
+        abs(m->cz - w->lastEdit.cz) <= 1) {
+        return -1.f;
+    }
+    const int dx = m->cx - cx;
+    const int dy = m->cy - cy;
+    const int dz = m->cz - cz;
+    return (float)(dx * dx + dy * dy + dz * dz);
+}
+
+static int compareUploads(const void *a, const void *b) {
+    const float pa = ((const pendingUpload_t *)a)->priority;
+    const float pb = ((const pendingUpload_t *)b)->priority;
+    return (pa > pb) - (pa < pb);
+}
+
+void world_remeshChunks(world_t *w, vec3 eye) {
+    const chunkSnapshot_t *s = w->readSnapshot;
+    if (!s) return;
+    size_t freed = 0;
+    chunkMesh_t *m;
+    while (spscRing_poll(&w->queues.meshQueue, (void **)&m)) {
+        freed += addPendingUpload(w, m);
+    }
+
+    const int cx = (int)floorf(eye[0]) >> 4;
+    const int cy = (int)floorf(eye[1]) >> 4;
+    const int cz = (int)floorf(eye[2]) >> 4;
+    for (size_t i = 0; i < w->uploads.n; i++) {
+        w->uploads.items[i].priority = uploadPriority(w, w->uploads.items[i].mesh, cx, cy, cz);
+    }
+    qsort(w->uploads.items, w->uploads.n, sizeof(pendingUpload_t), compareUploads);
+
+    const double start = monotonicTime();
+    worldUploadStats_t stats = { 0 };
+    size_t kept = 0;
+    for (size_t i = 0; i < w->uploads.n; i++) {
+        m = w->uploads.items[i].mesh;
+        // A mesh built after this snapshot waits until the render thread picks up a newer one
+        if (m->sequence > s->sequence) {
+            w->uploads.items[kept++] = w->uploads.items[i];
+            continue;
+        }
+        // The chunk may have been unloaded, and its memory reused, since it was meshed
+        if (chunkSnapshot_get(s, m->cx, m->cy, m->cz) == m->chunk) {
+            const bool overBudget = stats.uploaded > 0 &&
+                                    (stats.uploadedBytes >= UPLOAD_BUDGET_BYTES ||
+                                     (monotonicTime() - start) * 1e3 >= UPLOAD_BUDGET_MS);
+            if (overBudget) {
+                w->uploads.items[kept++] = w->uploads.items[i];
+                continue;
+            }
+            chunkMesh_upload(m->chunk, m, w);
+            stats.uploaded++;
+            stats.uploadedBytes += (size_t)m->nVertices * sizeof(vertex_t);
+        }
+        chunkMesh_free(m);
+        freed++;
+    }
+    w->uploads.n = kept;
+    stats.deferred = kept;
+    w->uploadStats = stats;
+
+    if (freed == 0) return;
+    atomic_fetch_sub_explicit(&w->meshesInFlight, freed, memory_order_release);
+    // The chunk loading thread can carry on meshing now there is room in the queue
+    if (atomic_exchange_explicit(&w->meshQueueFull, false, memory_order_relaxed)) {
+        world_wakeChunkLoading(w);
+    }
+}
+
+worldUploadStats_t world_getUploadStats(const world_t *w) {
+    return w->uploadStats;
+}
+
+void world_draw(const world_t *w, const int modelLocation, camera_t *cam, mat4 projection) {
+    double planes[6][4];
+    calculatePlanes(cam, projection, planes);
+
+    const chunkSnapshot_t *s = w->readSnapshot;
+    if (!s) return;
+
+    // draw all chunks that are visible
+    for (size_t i = 0; i < s->count; i++) {
+        if (shouldRender(cam, s->chunks[i], planes)) {
+            chunk_draw(s->chunks[i], modelLocation);
+        }
+    }
+}
+
+static void freeEntity(const worldEntity_t *e) {
+    glDeleteBuffers(1, &e->vbo);
+    glDeleteVertexArrays(1, &e->vao);
+    free(e->entity);
+}
+
+/**
+ * @brief Frees an unloaded chunk, once the render thread can no longer reach it
+ * @param ctx A pointer to a world
+ * @param obj A pointer to the chunk
+ */
+static void reclaimChunk(void *ctx, void *obj) {
+    world_t *w = ctx;
+    const chunk_t *c = obj;
+    atomic_fetch_sub_explicit(&w->meshBytes, (size_t)c->meshVertices * sizeof(vertex_t), memory_order_relaxed);
+    chunk_free(obj, &w->queues.chunkBufferFreeQueue);
+    pool_release(&w->pools.chunks, obj);
+}
+
+static void reclaimSnapshot(void *ctx, void *obj) {
+    (void)ctx;
+    chunkSnapshot_free(obj);
+}
+
+void world_free(world_t *w) {
+    // Anything retired was already unlinked from the clusters, so it is freed here
+    epoch_free(&w->epoch);
+    chunkSnapshot_free(atomic_load(&w->snapshot));
+
+    for (size_t ci = 0; ci < w->clusters.count; ci++) {
+        cluster_t *cluster = w->clusters.values[ci];
+        for (int i = 0; i < C_T * C_T * C_T; i++) {
+            if (!cluster->cells[i].chunk) continue;
+            chunk_free(cluster->cells[i].chunk, &w->queues.chunkBufferFreeQueue);
+            pool_release(&w->pools.chunks, cluster->cells[i].chunk);
+        }
+        pool_release(&w->pools.clusterCells, cluster->cells);
+        free(cluster);
+    }
+    clusterIndex_free(&w->clusters);
+    pool_free(&w->pools.chunks);
+    pool_free(&w->pools.clusterCells);
+    columnCache_free(&w->columns);
+
+    for (int i = 0; i < w->numEntities; i++) {
+        if (w->entities[i].needsFreeing) {
+            freeEntity(&w->entities[i]);
+        }
+    }
+
+    void *edit;
+    while (spscRing_poll(&w->queues.editQueue, &edit)) {
+        free(edit);
+    }
+    spscRing_free(&w->queues.editQueue);
+    while (spscRing_poll(&w->queues.editResultQueue, &edit)) {
+        free(edit);
+    }
+    spscRing_free(&w->queues.editResultQueue);
+    spscRing_free(&w->queues.chunkBufferFreeQueue);
+
+    void *mesh;
+    while (spscRing_poll(&w->queues.meshQueue, &mesh)) {
+        chunkMesh_free(mesh);
+    }
+    for (size_t i = 0; i < w->uploads.n; i++) {
+        chunkMesh_free(w->uploads.items[i].mesh);
+    }
+    free(w->uploads.items);
+    spscRing_free(&w->queues.meshQueue);
+    for (size_t i = 0; i < w->meshTasks.capacity; i++) {
+        free(w->meshTasks.items[i]);
+    }
+    free(w->meshTasks.items);
+    pthread_cond_destroy(&w->wake.cond);
+    pthread_mutex_destroy(&w->wake.lock);
+    jobPool_free(&w->jobs);
+    free(w->batch.values);
+    free(w->batch.chunks);
+    loadQueue_free(&w->loadQueue);
+    pthread_mutex_destroy(&w->view.lock);
+    free(w->retained.items);
+}
+
+void world_setGenerationThreads(world_t *w, const int nThreads) {
+    jobPool_free(&w->jobs);
+    jobPool_init(&w->jobs, nThreads);
+}
+
+void world_setTerrainSampling(world_t *w, const terrainSampling_e sampling) {
+    columnCache_setSampling(&w->columns, sampling);
+}
+
+bool world_genChunkLoader(world_t *w, unsigned int *id) {
+    for (int i = 0; i < MAX_CHUNK_LOADERS; i++) {
+        if (atomic_load_explicit(&w->chunkLoaders[i].active, memory_order_relaxed))
+            continue;
+        *id = i;
+        atomic_store_explicit(&w->chunkLoaders[i].active, true, memory_order_release);
+        world_wakeChunkLoading(w);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Moves a chunk loader and the end of its predicted path
+ * @param w A pointer to a world
+ * @param id The id of the chunk loader
+ * @param pos The new position
+ * @param predicted The new end of the predicted path
+ */
+static void moveChunkLoader(world_t *w, const unsigned int id, const float pos[3], const float predicted[3]) {
+    if (id >= MAX_CHUNK_LOADERS) return;
+    const int x = (int)pos[0];
+    const int y = (int)pos[1];
+    const int z = (int)pos[2];
+    const int px = (int)predicted[0];
+    const int py = (int)predicted[1];
+    const int pz = (int)predicted[2];
+    // Only crossing into another chunk changes which chunks are loaded
+    const bool moved = atomic_load_explicit(&w->chunkLoaders[id].x, memory_order_relaxed) >> 4 != x >> 4 ||
+                       atomic_load_explicit(&w->chunkLoaders[id].y, memory_order_relaxed) >> 4 != y >> 4 ||
+                       atomic_load_explicit(&w->chunkLoaders[id].z, memory_order_relaxed) >> 4 != z >> 4 ||
+                       atomic_load_explicit(&w->chunkLoaders[id].px, memory_order_relaxed) >> 4 != px >> 4 ||
+                       atomic_load_explicit(&w->chunkLoaders[id].py, memory_order_relaxed) >> 4 != py >> 4 ||
+                       atomic_load_explicit(&w->chunkLoaders[id].pz, memory_order_relaxed) >> 4 != pz >> 4;
+
+    // The chunk loading thread may see a mix of old and new coordinates for one pass,
+    // which only shifts the loaded area by a chunk until the next pass
+    atomic_store_explicit(&w->chunkLoaders[id].x, x, memory_order_relaxed);
+    atomic_store_explicit(&w->chunkLoaders[id].y, y, memory_order_relaxed);
+    atomic_store_explicit(&w->chunkLoaders[id].z, z, memory_order_relaxed);
+    atomic_store_explicit(&w->chunkLoaders[id].px, px, memory_order_relaxed);
+    atomic_store_explicit(&w->chunkLoaders[id].py, py, memory_order_relaxed);
+    atomic_store_explicit(&w->chunkLoaders[id].pz, pz, memory_order_relaxed);
+    if (moved) {
+        world_wakeChunkLoading(w);
+    }
+}
+
+void world_updateChunkLoader(world_t *w, const unsigned int id, const float pos[3]) {
+    moveChunkLoader(w, id, pos, pos);
+}
+
+void world_updateChunkLoaderPrefetch(world_t *w, const unsigned int id, const float pos[3], const float velocity[3]) {
+    vec3 ahead;
+    glm_vec3_scale((float *)velocity, PREFETCH_SECONDS, ahead);
+    // Falling or sprinting for long enough would otherwise prefetch a whole column
+    const float maxDistance = (float)(PREFETCH_MAX_CHUNKS * CHUNK_SIZE);
+    if (glm_vec3_norm(ahead) > maxDistance) {
+        glm_vec3_scale_as(ahead, maxDistance, ahead);
+    }
+    vec3 predicted;
+    glm_vec3_add((float *)pos, ahead, predicted);
+    moveChunkLoader(w, id, pos, predicted);
+}
+
+void world_delChunkLoader(world_t *w, const unsigned int id) {
+    atomic_store_explicit(&w->chunkLoaders[id].active, false, memory_order_release);
+    world_wakeChunkLoading(w);
+}
+
+void world_waitForChunkWork(world_t *w) {
+    // The memory budget needs another measurement, and a retained chunk may need
+    // unloading, even if nothing else happens
+    double timeout = -1.0;
+    if (w->viewDistanceSettle > 0) {
+        timeout = VIEW_DISTANCE_SETTLE_MS / 1000.0;
+    }
+    if (w->retained.deadline > 0) {
+        double untilDeadline = w->retained.deadline - monotonicTime();
+        untilDeadline = untilDeadline > 0 ? untilDeadline : 0;
+        timeout = timeout < 0 || untilDeadline < timeout ? untilDeadline : timeout;
+    }
+
+    pthread_mutex_lock(&w->wake.lock);
+    if (timeout >= 0) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (long)(timeout * 1e9);
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        while (!w->wake.pending) {
+            if (pthread_cond_timedwait(&w->wake.cond, &w->wake.lock, &deadline) == ETIMEDOUT) break;
+        }
+    } else {
+        while (!w->wake.pending) {
+            pthread_cond_wait(&w->wake.cond, &w->wake.lock);
+        }
+    }
+    w->wake.pending = false;
+    pthread_mutex_unlock(&w->wake.lock);
+}
+
+void world_wakeChunkLoading(world_t *w) {
+    pthread_mutex_lock(&w->wake.lock);
+    w->wake.pending = true;
+    pthread_cond_signal(&w->wake.cond);
+    pthread_mutex_unlock(&w->wake.lock);
+}
+
+static void unloadIfUnused(world_t *w, int cx, int cy, int cz);
+
+static void freeCv(world_t *w, cluster_t *cluster, const int i) {
+    chunkValue_t *cv = &cluster->cells[i];
+
+    // Children left without a parent are unloaded after this cell, as freeing it may
+    // free their cluster
+    ivec3 orphans[32];
+    int nOrphans = 0;
+    for (int j = 0; j < cv->loadData.nChildren; j++) {
+        chunkValue_t *child = cv->loadData.children[j];
+        if (--child->loadData.nParents == 0 && child->loadData.reload == REL_CHILD) {
+            child->loadData.reload = REL_TOMBSTONE;
+            glm_ivec3_copy((ivec3){ child->chunk->cx, child->chunk->cy, child->chunk->cz }, orphans[nOrphans++]);
+        }
+    }
+
+    unlinkNeighbours(cv->chunk);
+    // The render thread may still be drawing the chunk from the current snapshot, so
+    // it is only reclaimed after the next snapshot is published and the render
+    // thread has moved past the old one
+    if (cv->ll == LL_TOTAL) {
+        w->snapshotDirty = true;
+    }
+    epoch_retire(&w->epoch, cv->chunk, reclaimChunk, w);
+    cv->chunk = NULL;
+    cluster->n--;
+    if (cluster->n <= 0) {
+        clusterIndex_remove(&w->clusters, cluster->key);
+        pool_release(&w->pools.clusterCells, cluster->cells);
+        free(cluster);
+    }
+
+    for (int j = 0; j < nOrphans; j++) {
+        unloadIfUnused(w, orphans[j][0], orphans[j][1], orphans[j][2]);
+    }
+}
+
+/**
+ * @brief Unloads a chunk if no chunk loader and no other chunk holds it any more
+ * @param w A pointer to a world
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ */
+static void unloadIfUnused(world_t *w, const int cx, const int cy, const int cz) {
+    size_t offset;
+    cluster_t *cluster = clusterGet(w, cx, cy, cz, false, &offset);
+    if (!cluster) return;
+    chunkValue_t *cv = &cluster->cells[offset];
+    if (!cv->chunk || cv->loadData.nLoaders > 0) return;
+
+    if (cv->loadData.reload == REL_TOP_RELOAD) {
+        // Parents still point at this cell, so it is kept until the last of them is freed
+        cv->loadData.reload = cv->loadData.nParents > 0 ? REL_CHILD : REL_TOP_UNLOAD;
+    }
+    if (cv->loadData.reload == REL_TOP_UNLOAD || cv->loadData.reload == REL_TOMBSTONE) {
+        freeCv(w, cluster, (int)offset);
+    }
+}
+
+/**
+ * @brief Checks whether a chunk is in a load sphere
+ * @param s A pointer to a load sphere
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ * @return Whether the sphere contains the chunk
+ */
+static bool inLoadSphere(const loadSphere_t *s, const int cx, const int cy, const int cz) {
+    if (!s->active) return false;
+    const int dx = cx - s->cx;
+    const int dy = cy - s->cy;
+    const int dz = cz - s->cz;
+    return dx * dx + dy * dy + dz * dz <= s->radius * s->radius;
+}
+
+/**
+ * @brief Checks whether a chunk is within PREFETCH_RADIUS of a load sphere's
+ *        predicted path, the segment from its centre to the end of the path
+ * @param s A pointer to a load sphere
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ * @return Whether the chunk is on the path
+ */
+static bool onPrefetchPath(const loadSphere_t *s, const int cx, const int cy, const int cz) {
+    if (!s->active) return false;
+    const vec3 path = { (float)(s->px - s->cx), (float)(s->py - s->cy), (float)(s->pz - s->cz) };
+    const vec3 offset = { (float)(cx - s->cx), (float)(cy - s->cy), (float)(cz - s->cz) };
+    const float length2 = glm_vec3_norm2((float *)path);
+    const float t = length2 > 0.f ? glm_clamp(glm_vec3_dot((float *)offset, (float *)path) / length2, 0.f, 1.f) : 0.f;
+    vec3 closest;
+    glm_vec3_scale((float *)path, t, closest);
+    return glm_vec3_distance2((float *)offset, closest) <= (float)(PREFETCH_RADIUS * PREFETCH_RADIUS);
+}
+
+/**
+ * @brief Checks whether a chunk is kept loaded by a load sphere, either in the sphere
+ *        itself or on its predicted path
+ * @param s A pointer to a load sphere
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ * @return Whether the chunk is kept loaded
+ */
+static bool inLoadRegion(const loadSphere_t *s, const int cx, const int cy, const int cz) {
+    return inLoadSphere(s, cx, cy, cz) || onPrefetchPath(s, cx, cy, cz);
+}
+
+/**
+ * @brief Checks whether a chunk is close enough to a load sphere to be retained,
+ *        within RETAIN_MARGIN chunks beyond the sphere or on its predicted path
+ * @param s A pointer to a load sphere
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ * @return Whether the chunk is within the retain radius
+ */
+static bool inRetainRegion(const loadSphere_t *s, const int cx, const int cy, const int cz) {
+    if (!s->active) return false;
+    const int dx = cx - s->cx;
+    const int dy = cy - s->cy;
+    const int dz = cz - s->cz;
+    const int retainRadius = s->radius + RETAIN_MARGIN;
+    return dx * dx + dy * dy + dz * dz <= retainRadius * retainRadius || onPrefetchPath(s, cx, cy, cz);
+}
+
+/**
+ * @brief Keeps a chunk that has left every load sphere loaded until releaseRetained
+ *        decides it can go
+ * @param w A pointer to a world
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ */
+static void retainChunk(world_t *w, const int cx, const int cy, const int cz) {
+    if (w->retained.n == w->retained.capacity) {
+        const size_t capacity = w->retained.capacity ? w->retained.capacity * 2 : 256;
+        retainedChunk_t *items = realloc(w->retained.items, capacity * sizeof(retainedChunk_t));
+        if (!items) {
+            LOG_FATAL("Retained chunks realloc failed");
+        }
+        w->retained.items = items;
+        w->retained.capacity = capacity;
+    }
+    w->retained.items[w->retained.n++] = (retainedChunk_t){ .cx = cx, .cy = cy, .cz = cz, .since = monotonicTime() };
+}
+
+/**
+ * @brief Unloads the retained chunks that are outside every retain radius and past
+ *        their grace period, and forgets those a chunk loader has taken back
+ * @param w A pointer to a world
+ * @note Nothing is retained while over the memory budget, so the budget isn't held
+ *       up by chunks that are only kept in case they are needed again.
+ */
+static void releaseRetained(world_t *w) {
+    const double now = monotonicTime();
+    const double grace = UNLOAD_GRACE_MS / 1000.0;
+    const size_t budget = atomic_load_explicit(&w->memoryBudget, memory_order_relaxed);
+    const bool overBudget = budget > 0 && world_getMemoryStats(w).budgetedBytes > budget;
+
+    double deadline = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < w->retained.n; i++) {
+        const retainedChunk_t r = w->retained.items[i];
+        size_t offset;
+        const cluster_t *cluster = clusterGet(w, r.cx, r.cy, r.cz, false, &offset);
+        if (!cluster || !cluster->cells[offset].chunk || cluster->cells[offset].loadData.nLoaders > 0) continue;
+
+        bool nearLoader = false;
+        for (int j = 0; j < MAX_CHUNK_LOADERS && !nearLoader; j++) {
+            nearLoader = inRetainRegion(&w->loadSpheres[j], r.cx, r.cy, r.cz);
+        }
+        if (overBudget || (!nearLoader && now - r.since >= grace)) {
+            unloadIfUnused(w, r.cx, r.cy, r.cz);
+            continue;
+        }
+        if (!nearLoader && (deadline == 0 || r.since + grace < deadline)) {
+            deadline = r.since + grace;
+        }
+        w->retained.items[kept++] = r;
+    }
+    w->retained.n = kept;
+    w->retained.deadline = deadline;
+    atomic_store_explicit(&w->loadStats.retained, kept, memory_order_relaxed);
+}
+
+/**
+ * @brief Gets the chunk bounds of everything a load sphere keeps loaded
+ * @param s A pointer to a load sphere
+ * @param min Where to store the smallest chunk coordinates
+ * @param max Where to store the largest chunk coordinates
+ */
+static void loadRegionBounds(const loadSphere_t *s, ivec3 min, ivec3 max) {
+    const int centre[3] = { s->cx, s->cy, s->cz };
+    const int end[3] = { s->px, s->py, s->pz };
+    for (int i = 0; i < 3; i++) {
+        min[i] = glm_imin(centre[i] - s->radius, end[i] - PREFETCH_RADIUS);
+        max[i] = glm_imax(centre[i] + s->radius, end[i] + PREFETCH_RADIUS);
+    }
+}
+
+/**
+ * @brief Checks whether a terrain column is near enough to a chunk loader to be kept
+ * @param ctx A pointer to a world
+ * @param cx Chunk x coordinate
+ * @param cz Chunk z coordinate
+ * @return Whether the column is within RETAIN_MARGIN chunks of a load region, seen from above
+ */
+static bool columnWanted(void *ctx, const int cx, const int cz) {
+    const world_t *w = ctx;
+    for (int i = 0; i < MAX_CHUNK_LOADERS; i++) {
+        const loadSphere_t *s = &w->loadSpheres[i];
+        if (!s->active) continue;
+        ivec3 min, max;
+        loadRegionBounds(s, min, max);
+        if (cx >= min[0] - RETAIN_MARGIN && cx <= max[0] + RETAIN_MARGIN &&
+            cz >= min[2] - RETAIN_MARGIN && cz <= max[2] + RETAIN_MARGIN) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether two load spheres hold the same chunks
+ * @return Whether they are the same
+ */
+static bool loadSpheresEqual(const loadSphere_t *a, const loadSphere_t *b) {
+    if (!a->active || !b->active) return a->active == b->active;
+    return a->cx == b->cx && a->cy == b->cy && a->cz == b->cz && a->radius == b->radius &&
+           a->px == b->px && a->py == b->py && a->pz == b->pz;
+}
+
+/**
+ * @brief Makes sure the batch arrays can hold a number of chunks
+ * @param w A pointer to a world
+ * @param n The number of chunks
+ */
+static void reserveBatch(world_t *w, const size_t n) {
+    if (n <= w->batch.capacity) return;
+    size_t capacity = w->batch.capacity ? w->batch.capacity : 256;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    chunkValue_t **values = realloc(w->batch.values, capacity * sizeof(chunkValue_t *));
+    if (!values) {
+        LOG_FATAL("Batch realloc failed");
+    }
+    w->batch.values = values;
+    chunk_t **chunks = realloc(w->batch.chunks, capacity * sizeof(chunk_t *));
+    if (!chunks) {
+        LOG_FATAL("Batch realloc failed");
+    }
+    w->batch.chunks = chunks;
+    w->batch.capacity = capacity;
+}
+
+/**
+ * @brief Queues a chunk to have its terrain generated by generateQueued
+ * @param w A pointer to a world
+ * @param cv A pointer to the chunk's cell
+ * @note Queued chunks are marked LL_PARTIAL. The priority is filled in by the
+ *       reprioritisation that follows any change to the load spheres.
+ */
+static void queueGeneration(world_t *w, chunkValue_t *cv) {
+    cv->ll = LL_PARTIAL;
+    loadQueue_push(&w->loadQueue, (loadRequest_t){
+        .cx = cv->chunk->cx, .cy = cv->chunk->cy, .cz = cv->chunk->cz, .priority = 0.f
+    });
+}
+
+/**
+ * @brief Finds the cell a load request is for, if it still wants generating
+ * @param w A pointer to a world
+ * @param r A pointer to the request
+ * @return A pointer to the cell, or NULL if the request is stale
+ * @note A chunk can leave every load sphere, or be unloaded and loaded again, while
+ *       it waits
+ */
+static chunkValue_t *requestCell(world_t *w, const loadRequest_t *r) {
+    size_t offset;
+    cluster_t *cluster = clusterGet(w, r->cx, r->cy, r->cz, false, &offset);
+    if (!cluster) return NULL;
+    chunkValue_t *cv = &cluster->cells[offset];
+    if (!cv->chunk || cv->ll != LL_PARTIAL || cv->loadData.nLoaders == 0) return NULL;
+    return cv;
+}
+
+/**
+ * @brief Forgets a stale load request taken out of the queue
+ * @param ctx A pointer to a world
+ * @param r A pointer to the request
+ * @note A chunk still held by a neighbour but no longer by a chunk loader goes back
+ *       to LL_INIT, so it is queued again if it re-enters a load sphere.
+ */
+static void dropRequest(void *ctx, const loadRequest_t *r) {
+    world_t *w = ctx;
+    size_t offset;
+    cluster_t *cluster = clusterGet(w, r->cx, r->cy, r->cz, false, &offset);
+    if (!cluster) return;
+    chunkValue_t *cv = &cluster->cells[offset];
+    if (cv->chunk && cv->ll == LL_PARTIAL && cv->loadData.nLoaders == 0) {
+        cv->ll = LL_INIT;
+    }
+}
+
+/**
+ * @brief Gives a load request its priority, the squared distance to the nearest
+ *        chunk loader, scaled up by OUT_OF_VIEW_PRIORITY outside the camera frustum
+ *        and by PREFETCH_PRIORITY when only a predicted path holds it
+ * @param ctx A pointer to a world
+ * @param r A pointer to the request
+ * @return The priority, or -1 if the request is stale
+ */
+static float requestPriority(void *ctx, const loadRequest_t *r) {
+    world_t *w = ctx;
+    if (!requestCell(w, r)) return -1.f;
+
+    int nearest = INT_MAX;
+    bool prefetchOnly = true;
+    for (int i = 0; i < MAX_CHUNK_LOADERS; i++) {
+        const loadSphere_t *s = &w->loadSpheres[i];
+        if (!s->active) continue;
+        const int dx = r->cx - s->cx;
+        const int dy = r->cy - s->cy;
+        const int dz = r->cz - s->cz;
+        nearest = glm_imin(nearest, dx * dx + dy * dy + dz * dz);
+        prefetchOnly &= !inLoadSphere(s, r->cx, r->cy, r->cz);
+    }
+    // One more than the distance, so the chunk a loader is in still ranks by view
+    float priority = (float)nearest + 1.f;
+    if (w->loaderView.valid && !chunkInFrustum(w->loaderView.planes, r->cx, r->cy, r->cz)) {
+        priority *= OUT_OF_VIEW_PRIORITY;
+    }
+    if (prefetchOnly) {
+        priority *= PREFETCH_PRIORITY;
+    }
+    return priority;
+}
+
+static void generateJob(void *ctx, void *item) {
+    world_t *w = ctx;
+    chunk_t *c = item;
+    generateChunk(w, c, columnCache_get(&w->columns, c->cx, c->cz));
+}
+
+/**
+ * @brief Generates the terrain of the highest priority queued chunks in parallel,
+ *        then finishes them one at a time in priority order
+ * @param w A pointer to a world
+ * @param reprioritise Whether the load spheres have changed since the last pass
+ * @note Terrain generation only touches the chunk itself. Decorations spill into
+ *       neighbouring chunks through decorator_t, loading them if needed, so they wait
+ *       until the whole batch is generated and then run on this thread alone. A
+ *       neighbour outside the batch has its terrain generated on this thread before
+ *       the decoration touches it, and is skipped when its own batch comes, so the
+ *       result doesn't depend on the batch size or the number of threads.
+ */
+static void generateQueued(world_t *w, bool reprioritise) {
+    pthread_mutex_lock(&w->view.lock);
+    if (w->view.version != w->loaderView.version) {
+        memcpy(w->loaderView.planes, w->view.planes, sizeof(w->view.planes));
+        w->loaderView.valid = w->view.valid;
+        w->loaderView.version = w->view.version;
+        reprioritise = true;
+    }
+    pthread_mutex_unlock(&w->view.lock);
+
+    if (reprioritise) {
+        loadQueue_reprioritise(&w->loadQueue, requestPriority, dropRequest, w);
+    }
+
+    const size_t limit = (size_t)w->jobs.nThreads * LOAD_BATCH_PER_THREAD;
+    loadRequest_t r;
+    while (w->batch.n < limit && loadQueue_pop(&w->loadQueue, &r)) {
+        chunkValue_t *cv = requestCell(w, &r);
+        if (!cv) {
+            dropRequest(w, &r);
+            continue;
+        }
+        reserveBatch(w, w->batch.n + 1);
+        w->batch.values[w->batch.n] = cv;
+        w->batch.chunks[w->batch.n] = cv->chunk;
+        w->batch.n++;
+    }
+
+    const double start = monotonicTime();
+    // The columns are all computed before any chunk is generated, so the generation
+    // jobs only ever read the column cache
+    for (size_t i = 0; i < w->batch.n; i++) {
+        columnCache_request(&w->columns, w->batch.chunks[i]->cx, w->batch.chunks[i]->cz);
+    }
+    columnCache_generatePending(&w->columns, &w->jobs);
+    jobPool_run(&w->jobs, generateJob, w, (void **)w->batch.chunks, w->batch.n);
+    const double generated = monotonicTime();
+    for (size_t i = 0; i < w->batch.n; i++) {
+        finishChunk(w, w->batch.values[i]);
+    }
+    w->passTimes.generate = generated - start;
+    w->passTimes.decorate = monotonicTime() - generated;
+    w->passTimes.generated = w->batch.n;
+    atomic_fetch_add_explicit(&w->loadStats.generated, w->batch.n, memory_order_relaxed);
+    w->batch.n = 0;
+    atomic_store_explicit(&w->pendingChunks, w->loadQueue.size, memory_order_relaxed);
+}
+
+/**
+ * @brief A chunk's mesh input and the mesh built from it
+ */
+typedef struct meshTask_t {
+    meshInput_t input;
+    chunkMesh_t *mesh;
+} meshTask_t;
+
+/**
+ * @brief Makes sure there are enough mesh tasks for a batch
+ * @param w A pointer to a world
+ * @param n The number of chunks in the batch
+ */
+static void reserveMeshTasks(world_t *w, const size_t n) {
+    if (n <= w->meshTasks.capacity) return;
+    meshTask_t **items = realloc(w->meshTasks.items, n * sizeof(meshTask_t *));
+    if (!items) {
+        LOG_FATAL("Mesh task realloc failed");
+    }
+    w->meshTasks.items = items;
+    for (size_t i = w->meshTasks.capacity; i < n; i++) {
+        items[i] = malloc(sizeof(meshTask_t));
+        if (!items[i]) {
+            LOG_FATAL("Mesh task allocation failed");
         }
     }
-    return true;
+    w->meshTasks.capacity = n;
 }
 
-static void calculatePlanes(camera_t *cam, mat4 projection, double res[6][4]) {
-    mat4 view;
-    camera_createView(cam, view);
-    mat4 projview;
-    glm_mat4_mul(projection, view, projview);
+static void meshJob(void *ctx, void *item) {
+    (void)ctx;
+    meshTask_t *task = item;
+    task->mesh = chunkMesh_build(&task->input);
+}
 
-    for (int i = 0; i < 3; i++) {
-        res[i*2][0] = projview[0][3] + projview[0][i];
-        res[i*2][1] = projview[1][3] + projview[1][i];
-        res[i*2][2] = projview[2][3] + projview[2][i];
-        res[i*2][3] = projview[3][3] + projview[3][i];
+/**
+ * @brief Picks the level of detail to mesh a chunk at from its distance to the
+ *        nearest chunk loader
+ * @param w A pointer to a world
+ * @param cx Chunk x coordinate
+ * @param cy Chunk y coordinate
+ * @param cz Chunk z coordinate
+ * @return 1 for full detail, 2, or MAX_MESH_LOD
+ */
+static int chunkLod(const world_t *w, const int cx, const int cy, const int cz) {
+    const int distance = w->meshLodDistance;
+    if (distance == 0) return 1;
 
-        res[i*2+1][0] = projview[0][3] - projview[0][i];
-        res[i*2+1][1] = projview[1][3] - projview[1][i];
-        res[i*2+1][2] = projview[2][3] - projview[2][i];
-        res[i*2+1][3] = projview[3][3] - projview[3][i];
+    int nearest = INT_MAX;
+    for (int i = 0; i < MAX_CHUNK_LOADERS; i++) {
+        const loadSphere_t *s = &w->loadSpheres[i];
+        if (!s->active) continue;
+        const int dx = cx - s->cx;
+        const int dy = cy - s->cy;
+        const int dz = cz - s->cz;
+        nearest = glm_imin(nearest, dx * dx + dy * dy + dz * dz);
     }
+    // Inclusive like inLoadSphere, so the default distance keeps the whole load sphere at full detail
+    if (nearest <= distance * distance) return 1;
+    if (nearest <= 4 * distance * distance) return 2;
+    return MAX_MESH_LOD;
 }
 
-void world_remeshChunks(world_t *w) {
-    cluster_t *cluster, *tmp;
-
-    HASH_ITER(hh, w->clusterTable, cluster, tmp) {
-        for (int i = 0; i < C_T * C_T * C_T; i++) {
-            if (!cluster->cells[i].chunk || cluster->cells[i].ll != LL_TOTAL) {continue;}
-            if (cluster->cells[i].chunk) {
-                chunk_checkMesh(cluster->cells[i].chunk, w);
-            }
+/**
+ * @brief Finds the faces of a chunk towards neighbours meshed at another level of detail
+ * @param w A pointer to a world
+ * @param c A pointer to the chunk
+ * @param lod The chunk's level of detail
+ * @return Bit 1 << dir set for each such face
+ */
+static unsigned char lodSeams(const world_t *w, const chunk_t *c, const int lod) {
+    unsigned char seams = 0;
+    for (direction_e dir = 0; dir < 6; dir++) {
+        const int lodAcross = chunkLod(w, c->cx + directions[dir][0], c->cy + directions[dir][1],
+                                       c->cz + directions[dir][2]);
+        if (lodAcross != lod) {
+            seams |= 1 << dir;
         }
     }
+    return seams;
 }
 
-void world_draw(const world_t *w, const int modelLocation, camera_t *cam, mat4 projection) {
-    cluster_t *cluster, *tmp;
-    double planes[6][4];
-    calculatePlanes(cam, projection, planes);
-
-    // draw all chunks that are visible
-    HASH_ITER(hh, w->clusterTable, cluster, tmp) {
+/**
+ * @brief Taints every chunk whose level of detail has changed since it was meshed,
+ *        and its face neighbours, whose seams with it have changed too
+ * @param w A pointer to a world
+ */
+static void updateLods(world_t *w) {
+    for (size_t ci = 0; ci < w->clusters.count; ci++) {
+        const cluster_t *cluster = w->clusters.values[ci];
         for (int i = 0; i < C_T * C_T * C_T; i++) {
-            if (!cluster->cells[i].chunk || cluster->cells[i].ll != LL_TOTAL) {continue;}
-            const bool renderingChunk = shouldRender(cam, cluster->cells[i].chunk, planes);
-
-            if (cluster->cells[i].chunk && renderingChunk) {
-                chunk_draw(cluster->cells[i].chunk, modelLocation);
+            chunk_t *c = cluster->cells[i].chunk;
+            if (!c || cluster->cells[i].ll != LL_TOTAL) {continue;}
+            if (chunkLod(w, c->cx, c->cy, c->cz) == c->meshLod) {continue;}
+            c->tainted = true;
+            for (direction_e dir = 0; dir < 6; dir++) {
+                chunk_t *n = chunk_neighbour(c, directions[dir][0], directions[dir][1], directions[dir][2]);
+                if (n) {
+                    n->tainted = true;
+                }
             }
         }
     }
 }
 
-static void freeEntity(const worldEntity_t *e) {
-    glDeleteBuffers(1, &e->vbo);
-    glDeleteVertexArrays(1, &e->vao);
-    free(e->entity);
-}
+/**
+ * @brief Builds the meshes of tainted chunks in parallel
+ * @param w A pointer to a world
+ * @param spheresChanged Whether the load spheres have changed since the last pass,
+ *        which can move chunks between levels of detail
+ * @return The number of meshes built, left in the first mesh tasks for sendMeshes
+ * @note The blocks and light each mesh reads are copied out of the chunks first, so
+ *       the mesh jobs never touch a live chunk. At most MESH_BATCH_PER_THREAD chunks
+ *       per thread are meshed in one pass, and never more than the mesh queue has
+ *       room for, so a burst of edits can't hold up loading or flood the render thread.
+ */
+static size_t buildMeshes(world_t *w, const bool spheresChanged) {
+    const int lodDistance = atomic_load_explicit(&w->lodDistance, memory_order_relaxed);
+    if (spheresChanged || lodDistance != w->meshLodDistance) {
+        w->meshLodDistance = lodDistance;
+        updateLods(w);
+    }
 
-void world_free(world_t *w) {
-    cluster_t *cluster, *tmp;
+    const size_t batchLimit = (size_t)w->jobs.nThreads * MESH_BATCH_PER_THREAD;
+    const size_t room = MESH_QUEUE_SIZE - 1 - atomic_load_explicit(&w->meshesInFlight, memory_order_acquire);
+    const size_t limit = room < batchLimit ? room : batchLimit;
 
-    HASH_ITER(hh, w->clusterTable, cluster, tmp) {
-        HASH_DEL(w->clusterTable, cluster);
+    size_t n = 0;
+    bool more = false;
+    for (size_t ci = 0; ci < w->clusters.count && !more; ci++) {
+        const cluster_t *cluster = w->clusters.values[ci];
         for (int i = 0; i < C_T * C_T * C_T; i++) {
-            if (!cluster->cells[i].chunk) continue;
-            chunk_free(cluster->cells[i].chunk, &w->queues.chunkBufferFreeQueue);
-            free(cluster->cells[i].chunk);
+            chunk_t *c = cluster->cells[i].chunk;
+            if (!c || cluster->cells[i].ll != LL_TOTAL || !c->tainted) {continue;}
+            if (n == limit) {
+                more = true;
+                break;
+            }
+            reserveMeshTasks(w, n + 1);
+            const int lod = chunkLod(w, c->cx, c->cy, c->cz);
+            chunkMesh_capture(&w->meshTasks.items[n]->input, c, lod, lodSeams(w, c, lod));
+            c->meshLod = lod;
+            c->tainted = false;
+            n++;
         }
-        free(cluster->cells);
-        free(cluster);
     }
+    jobPool_run(&w->jobs, meshJob, NULL, (void **)w->meshTasks.items, n);
 
-    for (int i = 0; i < w->numEntities; i++) {
-        if (w->entities[i].needsFreeing) {
-            freeEntity(&w->entities[i]);
+    if (more) {
+        if (limit < batchLimit) {
+            // The render thread wakes the chunk loading thread once it has made room
+            atomic_store_explicit(&w->meshQueueFull, true, memory_order_relaxed);
+        } else {
+            world_wakeChunkLoading(w);
         }
     }
-
-    spscRing_free(&w->queues.chunkBufferFreeQueue);
-}
-
-bool world_genChunkLoader(world_t *w, unsigned int *id) {
-    for (int i = 0; i < MAX_CHUNK_LOADERS; i++) {
-        if (w->chunkLoaders[i].active)
-            continue;
-        *id = i;
-        return w->chunkLoaders[i].active = true;
-    }
-    return false;
+    return n;
 }
 
-void world_updateChunkLoader(world_t *w, const unsigned int id, const float pos[3]) {
-    w->chunkLoaders[id].x = (int)pos[0];
-    w->chunkLoaders[id].y = (int)pos[1];
-    w->chunkLoaders[id].z = (int)pos[2];
-}
+/**
+ * @brief Hands the meshes built by buildMeshes to the render thread
+ * @param w A pointer to a world
+ * @param n The number of meshes
+ * @note Called once the snapshot holding every meshed chunk has been published.
+ *       Each mesh carries that snapshot's sequence number, so the render thread
+ *       waits until it has picked the snapshot up before uploading the mesh.
+ */
+static void sendMeshes(world_t *w, const size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        chunkMesh_t *m = w->meshTasks.items[i]->mesh;
+        w->meshTasks.items[i]->mesh = NULL;
+        m->sequence = w->snapshotSequence;
+
+        if (atomic_load_explicit(&w->firstVisibleTime, memory_order_relaxed) < 0 && m->nVertices > 0 &&
+            (!w->loaderView.valid || chunkInFrustum(w->loaderView.planes, m->cx, m->cy, m->cz))) {
+            const double elapsed = monotonicTime() - w->startTime;
+            atomic_store_explicit(&w->firstVisibleTime, elapsed, memory_order_relaxed);
+            LOG_INFO("First chunk in view meshed %.1f ms after the world was created", elapsed * 1e3);
+        }
 
-void world_delChunkLoader(world_t *w, const unsigned int id) {
-    w->chunkLoaders[id].active = false;
+        // buildMeshes never builds more meshes than the queue has room for
+        atomic_fetch_add_explicit(&w->meshesInFlight, 1, memory_order_relaxed);
+        spscRing_offer(&w->queues.meshQueue, m);
+    }
 }
 
-static bool freeCv(world_t *w, cluster_t *cluster, const int i) {
-    chunkValue_t *cv = &cluster->cells[i];
-
-    for (int j = 0; j < cv->loadData.nChildren; j++) {
-        reloadData_e *r = &cv->loadData.children[j]->loadData.reload;
-        if (*r == REL_CHILD) *r = REL_TOMBSTONE;
+/**
+ * @brief Brings the loaded chunks in line with the chunk loaders, only touching the
+ *        chunks that entered or left a loader's load sphere since the last pass
+ * @param w A pointer to a world
+ * @return Whether any load sphere changed
+ * @note Chunks entering a sphere are queued for generateQueued rather than generated,
+ *       and chunks leaving the last sphere holding them are retained rather than
+ *       unloaded, so walking back and forth over a chunk boundary doesn't regenerate
+ *       a whole shell of chunks every time
+ */
+static bool updateLoadSpheres(world_t *w) {
+    const int radius = world_getViewDistance(w);
+    loadSphere_t next[MAX_CHUNK_LOADERS];
+    bool changed = false;
+    for (int i = 0; i < MAX_CHUNK_LOADERS; i++) {
+        next[i] = (loadSphere_t){
+            .active = atomic_load_explicit(&w->chunkLoaders[i].active, memory_order_acquire),
+            .cx = atomic_load_explicit(&w->chunkLoaders[i].x, memory_order_relaxed) >> 4,
+            .cy = atomic_load_explicit(&w->chunkLoaders[i].y, memory_order_relaxed) >> 4,
+            .cz = atomic_load_explicit(&w->chunkLoaders[i].z, memory_order_relaxed) >> 4,
+            .radius = radius,
+            .px = atomic_load_explicit(&w->chunkLoaders[i].px, memory_order_relaxed) >> 4,
+            .py = atomic_load_explicit(&w->chunkLoaders[i].py, memory_order_relaxed) >> 4,
+            .pz = atomic_load_explicit(&w->chunkLoaders[i].pz, memory_order_relaxed) >> 4,
+        };
+        changed |= !loadSpheresEqual(&w->loadSpheres[i], &next[i]);
     }
+    if (!changed) return false;
 
-    chunk_free(cv->chunk, &w->queues.chunkBufferFreeQueue);
-    free(cv->chunk);
-    cv->chunk = NULL;
-    cluster->n--;
-    if (cluster->n <= 0) {
-        HASH_DEL(w->clusterTable, cluster);
-        free(cluster->cells);
-        free(cluster);
-        return false;
+    // Everything entering a sphere is loaded before anything leaving one is unloaded,
+    // so a chunk passed from one loader to another is never unloaded in between
+    for (int i = 0; i < MAX_CHUNK_LOADERS; i++) {
+        const loadSphere_t *old = &w->loadSpheres[i];
+        const loadSphere_t *cur = &next[i];
+        if (!cur->active || loadSpheresEqual(old, cur)) continue;
+
+        ivec3 min, max;
+        loadRegionBounds(cur, min, max);
+        for (int x = min[0]; x <= max[0]; x++) {
+            for (int y = min[1]; y <= max[1]; y++) {
+                for (int z = min[2]; z <= max[2]; z++) {
+                    if (inLoadRegion(cur, x, y, z) && !inLoadRegion(old, x, y, z)) {
+                        chunkValue_t *cv = world_loadChunk(w, x, y, z, LL_INIT, REL_TOP_RELOAD);
+                        if (cv->ll == LL_TOTAL && cv->loadData.nLoaders == 0) {
+                            atomic_fetch_add_explicit(&w->loadStats.regenerationsAvoided, 1, memory_order_relaxed);
+                        }
+                        cv->loadData.nLoaders++;
+                        if (cv->ll == LL_INIT) {
+                            queueGeneration(w, cv);
+                        }
+                    }
+                }
+            }
+        }
     }
-    return true;
-}
 
-void world_doChunkLoading(world_t *w) {
-    // Iterate through chunk loaders, loading any chunk in their radius
     for (int i = 0; i < MAX_CHUNK_LOADERS; i++) {
-        if (!w->chunkLoaders[i].active)
-            continue;
-        const int cx = w->chunkLoaders[i].x >> 4;
-        const int cy = w->chunkLoaders[i].y >> 4;
-        const int cz = w->chunkLoaders[i].z >> 4;
-
-        for (int x = -CHUNK_LOAD_RADIUS; x <= CHUNK_LOAD_RADIUS; x++) {
-            for (int y = -CHUNK_LOAD_RADIUS; y <= CHUNK_LOAD_RADIUS; y++) {
-                for (int z = -CHUNK_LOAD_RADIUS; z <= CHUNK_LOAD_RADIUS; z++) {
-                    if (x * x + y * y + z * z <= CHUNK_LOAD_RADIUS * CHUNK_LOAD_RADIUS) {
-                        world_loadChunk(w, cx + x, cy + y, cz + z, LL_TOTAL, REL_TOP_RELOAD);
+        const loadSphere_t *old = &w->loadSpheres[i];
+        const loadSphere_t *cur = &next[i];
+        if (!old->active || loadSpheresEqual(old, cur)) continue;
+
+        // Prefetched chunks left behind by a changed path are cancelled here, a
+        // queued one is dropped by generateQueued once its cell is gone
+        ivec3 min, max;
+        loadRegionBounds(old, min, max);
+        for (int x = min[0]; x <= max[0]; x++) {
+            for (int y = min[1]; y <= max[1]; y++) {
+                for (int z = min[2]; z <= max[2]; z++) {
+                    if (!inLoadRegion(old, x, y, z) || inLoadRegion(cur, x, y, z)) continue;
+
+                    size_t offset;
+                    cluster_t *cluster = clusterGet(w, x, y, z, false, &offset);
+                    if (!cluster || !cluster->cells[offset].chunk) continue;
+                    if (--cluster->cells[offset].loadData.nLoaders == 0) {
+                        retainChunk(w, x, y, z);
                     }
                 }
             }
         }
     }
 
-    // Iterating through every loaded chunk, if the reloaded flag is false they will be deleted
-    cluster_t *cluster, *tmp;
-    HASH_ITER(hh, w->clusterTable, cluster, tmp) {
+    memcpy(w->loadSpheres, next, sizeof(next));
+    return true;
+}
+
+/**
+ * @brief Builds a snapshot of the fully loaded chunks, publishes it to the render
+ *        thread and retires the old one
+ * @param w A pointer to a world
+ */
+static void publishSnapshot(world_t *w) {
+    chunkSnapshot_t *s = chunkSnapshot_create(pool_getStats(&w->pools.chunks).live);
+    for (size_t ci = 0; ci < w->clusters.count; ci++) {
+        const cluster_t *cluster = w->clusters.values[ci];
         for (int i = 0; i < C_T * C_T * C_T; i++) {
-            chunkValue_t *cv = &cluster->cells[i];
-            if (!cv->chunk) continue;
-            if (cv->loadData.reload == REL_TOP_UNLOAD || cv->loadData.reload == REL_TOMBSTONE) {
-                if (!freeCv(w, cluster, i)) break;
-            } else if (cv->loadData.reload == REL_TOP_RELOAD) {
-                cv->loadData.reload = REL_TOP_UNLOAD;
+            if (cluster->cells[i].chunk && cluster->cells[i].ll == LL_TOTAL) {
+                chunkSnapshot_add(s, cluster->cells[i].chunk);
             }
         }
     }
 
+    s->sequence = ++w->snapshotSequence;
+    chunkSnapshot_t *old = atomic_exchange(&w->snapshot, s);
+    epoch_retire(&w->epoch, old, reclaimSnapshot, NULL);
+    w->snapshotDirty = false;
+}
+
+static void applyEdits(world_t *w);
+
+/**
+ * @brief Picks the view distance for the next chunk loading pass from the target
+ *        view distance and the memory budget
+ * @param w A pointer to a world
+ * @note Under a budget, the distance moves one chunk at a time and then waits for
+ *       unloaded chunks to be reclaimed, or new ones loaded, before it is measured
+ *       again. It only grows back once well under the budget, so it doesn't flip
+ *       back and forth at the limit.
+ */
+static void updateViewDistance(world_t *w) {
+    const int target = atomic_load_explicit(&w->targetViewDistance, memory_order_relaxed);
+    const size_t budget = atomic_load_explicit(&w->memoryBudget, memory_order_relaxed);
+    const int current = atomic_load_explicit(&w->viewDistance, memory_order_relaxed);
+
+    int next = glm_imin(current, target);
+    if (budget == 0) {
+        next = target;
+    } else if (w->viewDistanceSettle > 0) {
+        w->viewDistanceSettle--;
+    } else {
+        const size_t used = world_getMemoryStats(w).budgetedBytes;
+        if (used > budget && next > MIN_VIEW_DISTANCE) {
+            next--;
+            w->viewDistanceSettle = VIEW_DISTANCE_SETTLE_PASSES;
+            LOG_INFO("Over the memory budget (%zu of %zu bytes), reducing the view distance to %d",
+                     used, budget, next);
+        } else if (used < budget / 4 * 3 && next < target) {
+            next++;
+            w->viewDistanceSettle = VIEW_DISTANCE_SETTLE_PASSES;
+        }
+    }
+    atomic_store_explicit(&w->viewDistance, next, memory_order_relaxed);
+}
+
+void world_doChunkLoading(world_t *w) {
+    applyEdits(w);
+
+    updateViewDistance(w);
+    const bool spheresChanged = updateLoadSpheres(w);
+    releaseRetained(w);
+    if (spheresChanged) {
+        columnCache_evict(&w->columns, columnWanted, w);
+    }
+    generateQueued(w, spheresChanged);
+
+    const double lightStart = monotonicTime();
 
     // process darkness propagation between all chunks
     while (true) {
         bool deletionFinished = true;
-        HASH_ITER(hh, w->clusterTable, cluster, tmp) {
+        for (size_t ci = 0; ci < w->clusters.count; ci++) {
+            const cluster_t *cluster = w->clusters.values[ci];
             for (int i = 0; i < C_T * C_T * C_T; i++) {
                 if (!cluster->cells[i].chunk || cluster->cells[i].ll != LL_TOTAL) {continue;}
                 if (cluster->cells[i].chunk &&
@@ -418,7 +1601,8 @@ void world_doChunkLoading(world_t *w) {
     // process light propagation between all chunks
     while (true) {
         bool insertionFinished = true;
-        HASH_ITER(hh, w->clusterTable, cluster, tmp) {
+        for (size_t ci = 0; ci < w->clusters.count; ci++) {
+            const cluster_t *cluster = w->clusters.values[ci];
             for (int i = 0; i < C_T * C_T * C_T; i++) {
                 if (!cluster->cells[i].chunk || cluster->cells[i].ll != LL_TOTAL) {continue;}
                 if (cluster->cells[i].chunk &&
@@ -434,23 +1618,46 @@ void world_doChunkLoading(world_t *w) {
         }
     }
 
-    // void chunk_genMesh(chunk_t *c, world_t *w)
-    HASH_ITER(hh, w->clusterTable, cluster, tmp) {
-        for (int i = 0; i < C_T * C_T * C_T; i++) {
-            if (!cluster->cells[i].chunk || cluster->cells[i].ll != LL_TOTAL) {continue;}
-            if (cluster->cells[i].chunk) {
-                chunk_checkGenMesh(cluster->cells[i].chunk, w);
-            }
-        }
+    const double meshStart = monotonicTime();
+    w->passTimes.light = meshStart - lightStart;
+    const size_t nMeshed = buildMeshes(w, spheresChanged);
+    w->passTimes.mesh = monotonicTime() - meshStart;
+    w->passTimes.meshed = nMeshed;
+    if (w->snapshotDirty) {
+        publishSnapshot(w);
+    }
+    sendMeshes(w, nMeshed);
+    // Reclaims whatever the render thread has moved past, including the chunks
+    // freed above once it has picked up the new snapshot
+    epoch_advance(&w->epoch);
+    atomic_store_explicit(&w->reclaimPending, epoch_pending(&w->epoch) > 0, memory_order_relaxed);
+
+    // Whatever this pass left in the load queue is picked up by the next one
+    if (w->loadQueue.size > 0) {
+        world_wakeChunkLoading(w);
     }
 }
 
+void world_loadPendingChunks(world_t *w) {
+    do {
+        world_doChunkLoading(w);
+    } while (w->loadQueue.size > 0);
+}
+
+size_t world_getPendingChunks(const world_t *w) {
+    return atomic_load_explicit(&w->pendingChunks, memory_order_relaxed);
+}
+
+double world_getFirstVisibleTime(const world_t *w) {
+    return atomic_load_explicit(&w->firstVisibleTime, memory_order_relaxed);
+}
+
 bool world_getBlocki(world_t *w, const int x, const int y, const int z, blockData_t *bd) {
-    block_t *block;
     chunk_t *chunk;
-    if (!getBlockAddr(w, x, y, z, &block, &chunk)) return false;
+    ivec3 blockPos;
+    if (!getBlockChunk(w, x, y, z, &chunk, blockPos)) return false;
 
-    bd->type = *block;
+    bd->type = chunk_getBlock(chunk, blockPos[0], blockPos[1], blockPos[2]);
     bd->x = x;
     bd->y = y;
     bd->z = z;
@@ -485,23 +1692,66 @@ void world_getAdjacentBlocks(world_t *w, vec3 position, blockData_t *buf) {
     }
 }
 
-void world_getBlocksInRange(world_t *w, vec3 minPoint, const vec3 maxPoint, blockData_t *buf) {
-    int index = 0;
-
-    for (int dx = 0; dx < (int)(maxPoint[0] - minPoint[0]); dx++) {
-        for (int dy = 0; dy < (int)(maxPoint[1] - minPoint[1]); dy++) {
-            for (int dz = 0; dz < (int)(maxPoint[2] - minPoint[2]); dz++) {
-                vec3 delta = {(float)dx, (float)dy, (float)dz};
-
-                vec3 newBlockPosition;
+/**
+ * @brief Looks up the current chunk of a span and clips the span's box to it
+ * @param s A pointer to a span
+ */
+static void spanEnterChunk(worldSpan_t *s) {
+    for (int i = 0; i < 3; i++) {
+        const int base = s->chunkPos[i] << 4;
+        s->lo[i] = glm_imax(s->min[i], base) - base;
+        s->hi[i] = glm_imin(s->max[i], base + CHUNK_SIZE) - base;
+    }
+    s->chunk = s->snapshot ? chunkSnapshot_get(s->snapshot, s->chunkPos[0], s->chunkPos[1], s->chunkPos[2]) : NULL;
+    s->nextX = s->lo[0];
+    s->nextY = s->lo[1];
+}
 
-                glm_vec3_add(minPoint, delta, newBlockPosition);
+void world_spanBegin(const world_t *w, worldSpan_t *s, const ivec3 minPoint, const ivec3 maxPoint) {
+    s->snapshot = w->readSnapshot;
+    s->done = false;
+    for (int i = 0; i < 3; i++) {
+        s->min[i] = minPoint[i];
+        s->max[i] = maxPoint[i];
+        s->chunkPos[i] = minPoint[i] >> 4;
+        s->lastChunk[i] = (maxPoint[i] - 1) >> 4;
+        if (maxPoint[i] <= minPoint[i]) {
+            s->done = true;
+        }
+    }
+    if (!s->done) {
+        spanEnterChunk(s);
+    }
+}
 
-                world_getBlock(w, newBlockPosition, &buf[index]);
-                index++;
+bool world_spanNext(worldSpan_t *s) {
+    if (s->done) return false;
+
+    if (s->nextX == s->hi[0]) {
+        // The current chunk is finished, so move on to the next one in z, y then x order
+        if (++s->chunkPos[2] > s->lastChunk[2]) {
+            s->chunkPos[2] = s->min[2] >> 4;
+            if (++s->chunkPos[1] > s->lastChunk[1]) {
+                s->chunkPos[1] = s->min[1] >> 4;
+                if (++s->chunkPos[0] > s->lastChunk[0]) {
+                    s->done = true;
+                    return false;
+                }
             }
         }
+        spanEnterChunk(s);
     }
+
+    s->x = (s->chunkPos[0] << 4) + s->nextX;
+    s->y = (s->chunkPos[1] << 4) + s->nextY;
+    s->z = (s->chunkPos[2] << 4) + s->lo[2];
+    s->length = s->hi[2] - s->lo[2];
+
+    if (++s->nextY == s->hi[1]) {
+        s->nextY = s->lo[1];
+        s->nextX++;
+    }
+    return true;
 }
 
 block_t getBlockType(world_t *w, vec3 position) {
@@ -529,7 +1779,7 @@ static bool decorator_initSurface(decorator_t *d,
                                   const int z,
                                   const block_t block) {
     for (int y = CHUNK_SIZE - 1; y >= 0; y--) {
-        if (origin->chunk->blocks[x][y][z] == block) {
+        if (chunk_getBlock(origin->chunk, x, y, z) == block) {
             decorator_init(d, origin, x, y + 1, z);
             return true;
         }
@@ -555,6 +1805,11 @@ static bool decorator_testBlock(decorator_t *d, world_t *world, int x, int y, in
                                           d->origin->chunk->cz + cz,
                                           LL_INIT,
                                           REL_CHILD);
+            // A neighbour still waiting in the load queue has no terrain yet, and what the
+            // decoration sees mustn't depend on whether it was in the same batch
+            generateChunk(world, (*cacheValue)->chunk, columnCache_acquire(&world->columns,
+                                                                           (*cacheValue)->chunk->cx,
+                                                                           (*cacheValue)->chunk->cz));
             if (d->origin->loadData.nChildren > 31) {
                 LOG_FATAL("Buffer overflow in chunk children");
             }
@@ -567,10 +1822,11 @@ static bool decorator_testBlock(decorator_t *d, world_t *world, int x, int y, in
             }
             if (!found) {
                 d->origin->loadData.children[d->origin->loadData.nChildren++] = *cacheValue;
+                (*cacheValue)->loadData.nParents++;
             }
         }
 
-        const block_t b = (*cacheValue)->chunk->blocks[x - (cx << 4)][y - (cy << 4)][z - (cz << 4)];
+        const block_t b = chunk_getBlock((*cacheValue)->chunk, x - (cx << 4), y - (cy << 4), z - (cz << 4));
         return  b == BL_AIR || b == match;
     }
 
@@ -634,6 +1890,11 @@ static void decorator_placeBlock(decorator_t *d,
                                           d->origin->chunk->cz + cz,
                                           LL_INIT,
                                           REL_CHILD);
+            // A neighbour still waiting in the load queue has no terrain yet, and what the
+            // decoration sees mustn't depend on whether it was in the same batch
+            generateChunk(world, (*cacheValue)->chunk, columnCache_acquire(&world->columns,
+                                                                           (*cacheValue)->chunk->cx,
+                                                                           (*cacheValue)->chunk->cz));
             if (d->origin->loadData.nChildren > 31) {
                 LOG_FATAL("Buffer overflow in chunk children");
             }
@@ -646,6 +1907,7 @@ static void decorator_placeBlock(decorator_t *d,
             }
             if (!found) {
                 d->origin->loadData.children[d->origin->loadData.nChildren++] = *cacheValue;
+                (*cacheValue)->loadData.nParents++;
             }
         }
 
@@ -653,7 +1915,7 @@ static void decorator_placeBlock(decorator_t *d,
             return;
         }
 
-        (*cacheValue)->chunk->blocks[x - (cx << 4)][y - (cy << 4)][z - (cz << 4)] = block;
+        chunk_setBlock((*cacheValue)->chunk, x - (cx << 4), y - (cy << 4), z - (cz << 4), block);
         (*cacheValue)->chunk->tainted = true;
     }
 }
@@ -821,34 +2083,149 @@ static void play3DAudio(world_t *w, const char *filepath, const float x, const f
 }
 #endif
 
+/**
+ * @brief A batch of block writes queued by the render thread for the chunk loading thread
+ */
+typedef struct {
+    /// Whether writes replace any existing block, rather than only placing into air
+    bool replace;
+    /// Whether the chunk loading thread posts the batch back once applied, so the
+    /// render thread can spawn the item and play the sound of a single edit
+    bool notify;
+    /// Whether the first write was applied, set by the chunk loading thread
+    bool applied;
+    /// The block the first write replaced, set by the chunk loading thread
+    block_t replaced;
+    /// The number of writes
+    size_t n;
+    /// The writes, in the order they are applied
+    worldBlockEdit_t edits[];
+} worldEditBatch_t;
+
+/**
+ * @brief Allocates a batch of block writes
+ * @param n The number of writes
+ * @param replace Whether writes replace any existing block
+ * @return A pointer to the batch, with its writes uninitialised
+ */
+static worldEditBatch_t *allocBatch(const size_t n, const bool replace) {
+    worldEditBatch_t *batch = malloc(sizeof(worldEditBatch_t) + n * sizeof(worldBlockEdit_t));
+    if (!batch) {
+        LOG_FATAL("worldEditBatch allocation failed");
+    }
+    batch->replace = replace;
+    batch->notify = false;
+    batch->applied = false;
+    batch->replaced = BL_AIR;
+    batch->n = n;
+    return batch;
+}
+
+/**
+ * @brief Queues a batch of block writes for the chunk loading thread
+ * @param w A pointer to a world
+ * @param batch A pointer to the batch, freed if there is no room for it
+ * @return Whether there was room in the queue
+ */
+static bool queueBatch(world_t *w, worldEditBatch_t *batch) {
+    const worldBlockEdit_t first = batch->edits[0];
+    if (!spscRing_offer(&w->queues.editQueue, batch)) {
+        free(batch);
+        return false;
+    }
+    // The edited chunks' meshes jump the upload queue once they come back
+    w->lastEdit.valid = true;
+    w->lastEdit.cx = first.x >> 4;
+    w->lastEdit.cy = first.y >> 4;
+    w->lastEdit.cz = first.z >> 4;
+    world_wakeChunkLoading(w);
+    return true;
+}
+
 bool world_removeBlock(world_t *w, const int x, const int y, const int z) {
-    block_t *bp;
     chunk_t *cp;
-    if (!getBlockAddr(w, x, y, z, &bp, &cp)) return false;
+    ivec3 blockPos;
+    if (!getBlockChunk(w, x, y, z, &cp, blockPos)) return false;
 
-    if (*bp == BL_AIR) return false;
-    const worldEntity_t entity = createItemEntity(w, (vec3){(float)x + 0.5f, (float)y + 0.5f, (float)z + 0.5f}, BLOCK_TO_ITEM[*bp]);
-    world_addEntity(w, entity);
+    if (chunk_getBlock(cp, blockPos[0], blockPos[1], blockPos[2]) == BL_AIR) return false;
 
-    #ifdef ENABLE_AUDIO
-        play3DAudio(w, BLOCK_TO_AUDIO[*bp], (float)x, (float)y, (float)z);
-    #endif
+    worldEditBatch_t *batch = allocBatch(1, false);
+    batch->notify = true;
+    batch->edits[0] = (worldBlockEdit_t){ .x = x, .y = y, .z = z, .block = BL_AIR };
+    return queueBatch(w, batch);
+}
+
+bool world_placeBlock(world_t *w, const int x, const int y, const int z, const block_t block) {
+    chunk_t *cp;
+    ivec3 blockPos;
+    if (!getBlockChunk(w, x, y, z, &cp, blockPos)) return false;
+
+    if (chunk_getBlock(cp, blockPos[0], blockPos[1], blockPos[2]) != BL_AIR) {
+        return false;
+    }
+
+    worldEditBatch_t *batch = allocBatch(1, false);
+    batch->notify = true;
+    batch->edits[0] = (worldBlockEdit_t){ .x = x, .y = y, .z = z, .block = block };
+    return queueBatch(w, batch);
+}
+
+bool world_editRegion(world_t *w, const worldBlockEdit_t *edits, const size_t n) {
+    if (n == 0) return true;
+    worldEditBatch_t *batch = allocBatch(n, true);
+    memcpy(batch->edits, edits, n * sizeof(worldBlockEdit_t));
+    return queueBatch(w, batch);
+}
 
-    ivec3 blockPos = { x - ((x >> 4) << 4), y - ((y >> 4) << 4), z - ((z >> 4) << 4) };
+bool world_fillRegion(world_t *w, const ivec3 minPoint, const ivec3 maxPoint, const block_t block) {
+    const int size[3] = {
+        maxPoint[0] - minPoint[0],
+        maxPoint[1] - minPoint[1],
+        maxPoint[2] - minPoint[2],
+    };
+    if (size[0] <= 0 || size[1] <= 0 || size[2] <= 0) return true;
+
+    worldEditBatch_t *batch = allocBatch((size_t)size[0] * size[1] * size[2], true);
+    size_t n = 0;
+    // The writes are ordered chunk by chunk, so applying them looks each chunk up once
+    for (int cx = minPoint[0] >> 4; cx <= (maxPoint[0] - 1) >> 4; cx++) {
+        for (int cy = minPoint[1] >> 4; cy <= (maxPoint[1] - 1) >> 4; cy++) {
+            for (int cz = minPoint[2] >> 4; cz <= (maxPoint[2] - 1) >> 4; cz++) {
+                const int x1 = glm_imax(minPoint[0], cx << 4), x2 = glm_imin(maxPoint[0], (cx + 1) << 4);
+                const int y1 = glm_imax(minPoint[1], cy << 4), y2 = glm_imin(maxPoint[1], (cy + 1) << 4);
+                const int z1 = glm_imax(minPoint[2], cz << 4), z2 = glm_imin(maxPoint[2], (cz + 1) << 4);
+                for (int x = x1; x < x2; x++) {
+                    for (int y = y1; y < y2; y++) {
+                        for (int z = z1; z < z2; z++) {
+                            batch->edits[n++] = (worldBlockEdit_t){ .x = x, .y = y, .z = z, .block = block };
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return queueBatch(w, batch);
+}
 
-    unsigned char torchValue = EXTRACT_TORCH(cp->lightMap[blockPos[0]][blockPos[1]][blockPos[2]]);
-    block_t oBlock = *bp;
-    *bp = BL_AIR;
+/**
+ * @brief Removes a block and queues the lighting updates, on the chunk loading thread
+ * @param cp A pointer to the chunk holding the block
+ * @param blockPos The block's position within the chunk
+ * @param oBlock The block being removed, which isn't air
+ */
+static void removeBlockAt(chunk_t *cp, const ivec3 blockPos, const block_t oBlock) {
+    unsigned char torchValue = EXTRACT_TORCH(chunk_light(cp, blockPos[0], blockPos[1], blockPos[2]));
+    chunk_setBlock(cp, blockPos[0], blockPos[1], blockPos[2], BL_AIR);
     if (oBlock == BL_GLOWSTONE) {
         lightQueueItem_t qi = {
-            .pos = { x - ((x >> 4) << 4), y - ((y >> 4) << 4), z - ((z >> 4) << 4) },
+            .pos = { blockPos[0], blockPos[1], blockPos[2] },
             .lightValue = torchValue };
         queue_push(&cp->lightTorchDeletionQueue, qi);
     }
     for (int dir = 0; dir < 6; ++dir) {
         ivec3 nPos;
         memcpy(nPos, directions[dir], sizeof(ivec3));
-        glm_ivec3_add(nPos, blockPos, nPos);
+        glm_ivec3_add(nPos, (int *)blockPos, nPos);
         ivec3 chunkOffset = { 0, 0, 0 };
         for (int i = 0; i < 3; ++i) {
             if (nPos[i] < 0) {
@@ -860,18 +2237,16 @@ bool world_removeBlock(world_t *w, const int x, const int y, const int z) {
             }
         }
         if (chunkOffset[0] != 0 || chunkOffset[1] != 0 || chunkOffset[2] != 0) {
-            ivec3 cPos = {cp->cx, cp->cy, cp->cz};
-            glm_ivec3_add(cPos, chunkOffset, cPos);
-            chunk_t *nChunk = world_getFullyLoadedChunk(w, cPos[0], cPos[1], cPos[2]);
+            chunk_t *nChunk = chunk_neighbour(cp, chunkOffset[0], chunkOffset[1], chunkOffset[2]);
             if (nChunk) {
                 nChunk->tainted = true;
-                unsigned char light = EXTRACT_SUN(nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]]);
+                unsigned char light = EXTRACT_SUN(chunk_light(nChunk, nPos[0], nPos[1], nPos[2]));
                 if (light > 0) {
                     lightQueueItem_t qi = { .lightValue = light };
                     memcpy(qi.pos, nPos, sizeof(ivec3));
                     queue_push(&nChunk->lightSunInsertionQueue, qi);
                 }
-                light = EXTRACT_TORCH(nChunk->lightMap[nPos[0]][nPos[1]][nPos[2]]);
+                light = EXTRACT_TORCH(chunk_light(nChunk, nPos[0], nPos[1], nPos[2]));
                 if (light > 0) {
                     lightQueueItem_t qi = { .lightValue = light };
                     memcpy(qi.pos, nPos, sizeof(ivec3));
@@ -879,13 +2254,13 @@ bool world_removeBlock(world_t *w, const int x, const int y, const int z) {
                 }
             }
         } else {
-            unsigned char light = EXTRACT_SUN(cp->lightMap[nPos[0]][nPos[1]][nPos[2]]);
+            unsigned char light = EXTRACT_SUN(chunk_light(cp, nPos[0], nPos[1], nPos[2]));
             if (light > 0) {
                 lightQueueItem_t qi = { .lightValue = light };
                 memcpy(qi.pos, nPos, sizeof(ivec3));
                 queue_push(&cp->lightSunInsertionQueue, qi);
             }
-            light = EXTRACT_TORCH(cp->lightMap[nPos[0]][nPos[1]][nPos[2]]);
+            light = EXTRACT_TORCH(chunk_light(cp, nPos[0], nPos[1], nPos[2]));
             if (light > 0) {
                 lightQueueItem_t qi = { .lightValue = light };
                 memcpy(qi.pos, nPos, sizeof(ivec3));
@@ -894,51 +2269,130 @@ bool world_removeBlock(world_t *w, const int x, const int y, const int z) {
         }
     }
     cp->tainted = true;
-
-    return true;
 }
 
-bool world_placeBlock(world_t *w, const int x, const int y, const int z, const block_t block) {
-    block_t *bp;
-    chunk_t *cp;
-    if (!getBlockAddr(w, x, y, z, &bp, &cp)) return false;
-
-    if (*bp != BL_AIR) {
-        return false;
-    }
-
-    // audio found here: https://pixabay.com/sound-effects/stone-effect-254998/ (block_place.mp3)
-    // audio found here: https://pixabay.com/sound-effects/wood-effect-254997/ (block_place2.mp3)
-    play3DAudio(w, "../../src/audio/block_place2.mp3", (float)x, (float)y, (float)z);
-
-    const ivec3 blockPos = { x - ((x >> 4) << 4), y - ((y >> 4) << 4), z - ((z >> 4) << 4) };
-
-    *bp = block;
+/**
+ * @brief Places a block and queues the lighting updates, on the chunk loading thread
+ * @param cp A pointer to the chunk holding the block
+ * @param blockPos The block's position within the chunk
+ * @param block The type of block to place, which isn't air
+ */
+static void placeBlockAt(chunk_t *cp, const ivec3 blockPos, const block_t block) {
+    chunk_setBlock(cp, blockPos[0], blockPos[1], blockPos[2], block);
     if (block == BL_GLOWSTONE) {
         lightQueueItem_t qi = {
             .lightValue = LIGHT_MAX_VALUE};
-        memcpy(&qi.pos, &blockPos, sizeof(ivec3));
+        memcpy(&qi.pos, blockPos, sizeof(ivec3));
         queue_push(&cp->lightTorchInsertionQueue, qi);
     }
-    const int sunValue = EXTRACT_SUN(cp->lightMap[blockPos[0]][blockPos[1]][blockPos[2]]);
-    int torchValue = EXTRACT_TORCH(cp->lightMap[blockPos[0]][blockPos[1]][blockPos[2]]);
-    LOG_DEBUG("torch value: %d, sun value: %d", torchValue, sunValue);
-    LOG_DEBUG("block pos %d, %d, %d", blockPos[0], blockPos[1], blockPos[2]);
+    const int sunValue = EXTRACT_SUN(chunk_light(cp, blockPos[0], blockPos[1], blockPos[2]));
+    const int torchValue = EXTRACT_TORCH(chunk_light(cp, blockPos[0], blockPos[1], blockPos[2]));
     if (sunValue > 0) {
         lightQueueItem_t qi = {
             .lightValue = sunValue };
-        memcpy(&qi.pos, &blockPos, sizeof(ivec3));
+        memcpy(&qi.pos, blockPos, sizeof(ivec3));
         queue_push(&cp->lightSunDeletionQueue, qi);
     }
     if (torchValue > 0) {
         lightQueueItem_t qi = {
             .lightValue = torchValue };
-        memcpy(&qi.pos, &blockPos, sizeof(ivec3));
+        memcpy(&qi.pos, blockPos, sizeof(ivec3));
         queue_push(&cp->lightTorchDeletionQueue, qi);
     }
     cp->tainted = true;
+}
 
-    return true;
+/**
+ * @brief Applies a batch of block writes, on the chunk loading thread
+ * @param w A pointer to a world
+ * @param batch A pointer to the batch
+ * @note Writes only seed the light queues and taint chunks. The light propagation
+ *       and remeshing later in the same pass then run once for the whole batch.
+ */
+static void applyBatch(world_t *w, worldEditBatch_t *batch) {
+    // Writes tend to run through one chunk at a time, so the last chunk looked up is
+    // reused rather than hashing every block
+    chunk_t *cp = NULL;
+    int cx = 0, cy = 0, cz = 0;
+    bool cached = false;
+
+    for (size_t i = 0; i < batch->n; i++) {
+        const worldBlockEdit_t *edit = &batch->edits[i];
+        if (!cached || edit->x >> 4 != cx || edit->y >> 4 != cy || edit->z >> 4 != cz) {
+            cx = edit->x >> 4;
+            cy = edit->y >> 4;
+            cz = edit->z >> 4;
+            cp = world_getFullyLoadedChunk(w, cx, cy, cz);
+            cached = true;
+        }
+        // Writes to chunks that were unloaded in the meantime are dropped
+        if (!cp) continue;
+
+        const ivec3 blockPos = { edit->x - (cx << 4), edit->y - (cy << 4), edit->z - (cz << 4) };
+        // The block may have changed since the render thread queued the edit
+        const block_t oBlock = chunk_getBlock(cp, blockPos[0], blockPos[1], blockPos[2]);
+        if (oBlock == edit->block) continue;
+
+        if (edit->block == BL_AIR) {
+            removeBlockAt(cp, blockPos, oBlock);
+        } else if (batch->replace || oBlock == BL_AIR) {
+            placeBlockAt(cp, blockPos, edit->block);
+        } else {
+            continue;
+        }
+        if (i == 0) {
+            batch->applied = true;
+            batch->replaced = oBlock;
+        }
+    }
+}
+
+/**
+ * @brief Applies every block edit queued by the render thread
+ * @param w A pointer to a world
+ */
+static void applyEdits(world_t *w) {
+    worldEditBatch_t *batch;
+    while (spscRing_poll(&w->queues.editQueue, (void **)&batch)) {
+        applyBatch(w, batch);
+        // Without room to post the batch back its item and sound are lost, not the edit
+        if (!batch->notify || !spscRing_offer(&w->queues.editResultQueue, batch)) {
+            free(batch);
+        }
+    }
+}
+
+/**
+ * @brief Spawns the items and plays the sounds of single edits the chunk loading
+ *        thread has applied, on the render thread
+ * @param w A pointer to a world
+ * @note Only edits that actually changed a block come back applied, so removing a
+ *       block twice before the first removal lands drops a single item.
+ */
+static void processEditResults(world_t *w) {
+    worldEditBatch_t *batch;
+    while (spscRing_poll(&w->queues.editResultQueue, (void **)&batch)) {
+        const worldBlockEdit_t *edit = &batch->edits[0];
+        const float x = (float)edit->x;
+        const float y = (float)edit->y;
+        const float z = (float)edit->z;
+        if (batch->applied && edit->block == BL_AIR) {
+            const worldEntity_t entity = createItemEntity(w, (vec3){ x + 0.5f, y + 0.5f, z + 0.5f },
+                                                          BLOCK_TO_ITEM[batch->replaced]);
+            world_addEntity(w, entity);
+
+            #ifdef ENABLE_AUDIO
+            play3DAudio(w, BLOCK_TO_AUDIO[batch->replaced], x, y, z);
+            #endif
+        } else if (batch->applied) {
+            // audio found here: https://pixabay.com/sound-effects/stone-effect-254998/ (block_place.mp3)
+            // audio found here: https://pixabay.com/sound-effects/wood-effect-254997/ (block_place2.mp3)
+            #ifdef ENABLE_AUDIO
+            play3DAudio(w, "../../src/audio/block_place2.mp3", x, y, z);
+            #endif
+        }
+        free(batch);
+    }
 }
 
 bool world_save(const world_t *w, const char *dir) {
@@ -959,8 +2413,8 @@ bool world_save(const world_t *w, const char *dir) {
     char *nameBuf = (char *)malloc(dirLen + 64);
     block_t *empty = (block_t *)malloc(sizeof(block_t) * CHUNK_SIZE_CUBED);
 
-    cluster_t *cluster, *tmp;
-    HASH_ITER(hh, w->clusterTable, cluster, tmp) {
+    for (size_t ci = 0; ci < w->clusters.count; ci++) {
+        const cluster_t *cluster = w->clusters.values[ci];
         sprintf(nameBuf, "%s%d %d %d.cluster", dir, cluster->key.x, cluster->key.y, cluster->key.z);
 
         FILE *fp = fopen(nameBuf, "wb");
@@ -993,6 +2447,41 @@ bool world_save(const world_t *w, const char *dir) {
     return true;
 }
 
+/**
+ * @brief Reads blocks along a path, only looking a chunk up when the path enters it
+ */
+typedef struct {
+    /// The chunk coordinates of the current chunk
+    int cx, cy, cz;
+    /// The current chunk, or NULL if it isn't loaded
+    const chunk_t *chunk;
+    /// Whether a chunk has been looked up yet
+    bool valid;
+} chunkCursor_t;
+
+/**
+ * @brief Gets the type of the block at a position through a chunk cursor
+ * @param w A pointer to a world
+ * @param cursor A pointer to a chunk cursor
+ * @param position The position to get a block at
+ * @return The type of the block, or BL_AIR if its chunk isn't loaded
+ */
+static block_t cursorGetBlock(const world_t *w, chunkCursor_t *cursor, const vec3 position) {
+    const int x = (int)floorf(position[0]);
+    const int y = (int)floorf(position[1]);
+    const int z = (int)floorf(position[2]);
+
+    if (!cursor->valid || x >> 4 != cursor->cx || y >> 4 != cursor->cy || z >> 4 != cursor->cz) {
+        cursor->cx = x >> 4;
+        cursor->cy = y >> 4;
+        cursor->cz = z >> 4;
+        cursor->chunk = w->readSnapshot ? chunkSnapshot_get(w->readSnapshot, cursor->cx, cursor->cy, cursor->cz) : NULL;
+        cursor->valid = true;
+    }
+    if (!cursor->chunk) return BL_AIR;
+    return chunk_getBlock(cursor->chunk, x - (cursor->cx << 4), y - (cursor->cy << 4), z - (cursor->cz << 4));
+}
+
 raycast_t world_raycast(world_t *w, vec3 startPosition, vec3 viewDirection, const float raycastDistance) {
     vec3 viewNormalised;
     glm_vec3_copy(viewDirection, viewNormalised);
@@ -1029,9 +2518,10 @@ raycast_t world_raycast(world_t *w, vec3 startPosition, vec3 viewDirection, cons
     float totalDistance = 0;
 
     raycastFace_e currentFace = POS_X_FACE;
+    chunkCursor_t cursor = { .valid = false };
 
     // Check starting block first
-    if (getBlockType(w, currentBlock) != BL_AIR) {
+    if (cursorGetBlock(w, &cursor, currentBlock) != BL_AIR) {
         return (raycast_t){
             .blockPosition = {currentBlock[0], currentBlock[1], currentBlock[2]},
             .face = currentFace,
@@ -1041,7 +2531,7 @@ raycast_t world_raycast(world_t *w, vec3 startPosition, vec3 viewDirection, cons
 
     while (totalDistance < raycastDistance) {
         // checks for a solid block
-        if (getBlockType(w, currentBlock) != BL_AIR) {
+        if (cursorGetBlock(w, &cursor, currentBlock) != BL_AIR) {
             return (raycast_t){
                 .blockPosition = {currentBlock[0], currentBlock[1], currentBlock[2]},
                 .face = currentFace,
@@ -1184,6 +2674,7 @@ void world_drawHighlight(const world_t *w, const int modelLocation) {
 }
 
 void world_processAllEntities(world_t *w, const double dt) {
+    processEditResults(w);
     for (int i = 0; i < w->numEntities; i++) {
         if (w->entities[i].type != WE_NONE) {
             if (w->entities[i].type == WE_ITEM) {
@@ -3,16 +3,25 @@
 
 #include <cglm/cglm.h>
 #include <glad/gl.h>
+#include <pthread.h>
 #include "camera.h"
 #include "chunk.h"
+#include "chunkmesh.h"
+#include "chunksnapshot.h"
+#include "columncache.h"
+#include "epoch.h"
+#include "jobpool.h"
 #include "item.h"
+#include "loadqueue.h"
 #include "noise.h"
 #include "player.h"
-#include "uthash.h"
+#include "clusterindex.h"
+#include "pool.h"
 #include "spscqueue.h"
 
 /*
- * NOTE: ENABLE_AUDIO is defined in block.h
+ * NOTE: ENABLE_AUDIO is defined in block.h, except in WORLD_HEADLESS builds, which
+ *       also never touch OpenGL from world_init or chunk loading
  */
 
 #ifdef ENABLE_AUDIO
@@ -25,10 +34,65 @@
 #define C_T 8
 #define LOG_C_T 3
 
+/// The view distance in chunks until world_setViewDistance is called
 #define CHUNK_LOAD_RADIUS 7
+/// The distance in chunks from a chunk loader beyond which meshes drop to half detail
+/// until world_setLodDistance is called, and twice it beyond which they drop to a quarter
+#define DEFAULT_LOD_DISTANCE CHUNK_LOAD_RADIUS
+/// The smallest view distance in chunks, which the memory budget never shrinks below
+#define MIN_VIEW_DISTANCE 2
+/// The largest view distance in chunks
+#define MAX_VIEW_DISTANCE 16
+/// The chunk loading passes the memory budget waits for after changing the view distance
+#define VIEW_DISTANCE_SETTLE_PASSES 8
+/// How long the chunk loading thread sleeps between passes while the memory budget settles
+#define VIEW_DISTANCE_SETTLE_MS 50
+
+/// The most block edits that can wait for the chunk loading thread at once
+#define WORLD_EDIT_QUEUE_SIZE 256
+
+/// How many chunks beyond the view distance a chunk that left a load sphere is kept
+#define RETAIN_MARGIN 2
+/// How long a chunk that left every load sphere is kept for, even outside the retain radius
+#define UNLOAD_GRACE_MS 2000
+
+/// How far ahead in seconds a prefetching chunk loader predicts its path
+#define PREFETCH_SECONDS 2.f
+/// The furthest in chunks a predicted path reaches from its chunk loader
+#define PREFETCH_MAX_CHUNKS 8
+/// The radius in chunks of the tube of chunks prefetched along a predicted path
+#define PREFETCH_RADIUS 1
+/// How much later a prefetched chunk is generated than one in a load sphere at the same distance
+#define PREFETCH_PRIORITY 2.f
+
+/// The chunks generated per generation thread in one chunk loading pass
+#define LOAD_BATCH_PER_THREAD 8
+/// The chunks meshed per generation thread in one chunk loading pass
+#define MESH_BATCH_PER_THREAD 16
+/// The capacity of the queue of meshes waiting for the render thread, a power of two
+#define MESH_QUEUE_SIZE 1024
+/// The most bytes of chunk meshes uploaded to the GPU in one frame
+#define UPLOAD_BUDGET_BYTES (2 * 1024 * 1024)
+/// The most milliseconds spent uploading chunk meshes in one frame
+#define UPLOAD_BUDGET_MS 2.0
+/// How much later a chunk outside the camera frustum is generated than one inside at the same distance
+#define OUT_OF_VIEW_PRIORITY 4.f
 
-#define FOG_START 16.f * (CHUNK_LOAD_RADIUS - 2)
-#define FOG_END 16.f * (CHUNK_LOAD_RADIUS - 1)
+/*
+ * The number of released chunks and cluster cell arrays kept for reuse. A chunk is
+ * about 5KiB plus its packed blocks and a cell array about 150KiB, so the Pi keeps
+ * far fewer around.
+ */
+#ifdef BUILD_FOR_RPI
+#define CHUNK_POOL_HIGH_WATER 64
+#define CLUSTER_POOL_HIGH_WATER 4
+#else
+#define CHUNK_POOL_HIGH_WATER 512
+#define CLUSTER_POOL_HIGH_WATER 16
+#endif
+
+#define FOG_START(viewDistance) (16.f * (float)((viewDistance) - 2))
+#define FOG_END(viewDistance) (16.f * (float)((viewDistance) - 1))
 
 #define GRAVITY_ACCELERATION (-10.f)
 
@@ -59,17 +123,204 @@ typedef struct {
     GLuint vbo;
 } worldEntity_t;
 
+/**
+ * @brief A chunk that has left every load sphere but is kept loaded for a while, in
+ *        case a chunk loader comes back for it
+ */
+typedef struct {
+    /// The chunk's coordinates
+    int cx, cy, cz;
+    /// When the chunk left the last load sphere, in seconds on the monotonic clock
+    double since;
+} retainedChunk_t;
+
+/**
+ * @brief The chunks a chunk loader keeps loaded, which is every chunk within the
+ *        view distance of the chunk it is in, plus the chunks within PREFETCH_RADIUS
+ *        of its predicted path when it prefetches
+ */
+typedef struct {
+    /// Whether the chunk loader is active, otherwise it keeps nothing loaded
+    bool active;
+    /// The chunk coordinates of the centre
+    int cx, cy, cz;
+    /// The radius in chunks
+    int radius;
+    /// The chunk coordinates the predicted path ends at, the centre when not prefetching
+    int px, py, pz;
+} loadSphere_t;
+
+/**
+ * @brief How long the stages of the last chunk loading pass took, in seconds
+ */
+typedef struct {
+    /// Generating terrain, in parallel
+    double generate;
+    /// Decorating, sunlighting and linking the newly generated chunks
+    double decorate;
+    /// Propagating light and darkness
+    double light;
+    /// Capturing and building meshes
+    double mesh;
+    /// The number of chunks generated
+    size_t generated;
+    /// The number of meshes built
+    size_t meshed;
+} worldPassTimes_t;
+
+/**
+ * @brief What the last world_remeshChunks call uploaded and left for later frames
+ */
+typedef struct {
+    /// The number of meshes uploaded
+    size_t uploaded;
+    /// The bytes of vertices uploaded
+    size_t uploadedBytes;
+    /// The number of meshes left waiting for a later frame
+    size_t deferred;
+} worldUploadStats_t;
+
 /**
  * @brief A struct that holds data about the world.
+ * @note The world is shared between two threads. The chunk loading thread owns the
+ *       cluster index and every chunk: it alone loads, generates, edits, lights,
+ *       meshes and frees them. The render thread only sees fully loaded chunks
+ *       through the published snapshot, inside world_beginRead and world_endRead,
+ *       and never blocks on the chunk loading thread. Meshes are built from copies
+ *       of the chunks' blocks and light and handed to the render thread through a
+ *       queue, which uploads them in place of the meshes drawn until then. Chunks and palette buffers
+ *       that the render thread might still hold are retired to the epoch and only
+ *       reclaimed once it has left the read section it found them in. Block edits
+ *       from the render thread are queued and applied by the chunk loading thread.
  */
 typedef struct world_t {
-    /// The array of chunk loaders present
+    /// The array of chunk loaders present, written by the render thread and read by the chunk loading thread
     struct {
-        bool active;
-        int x, y, z;
+        atomic_bool active;
+        atomic_int x, y, z;
+        /// The block position the predicted path ends at, the position itself when not prefetching
+        atomic_int px, py, pz;
     } chunkLoaders[MAX_CHUNK_LOADERS];
-    /// The hash table used keeping track of chunks
-    struct _s_cluster *clusterTable;
+    /// The view distance in chunks asked for with world_setViewDistance
+    atomic_int targetViewDistance;
+    /// The view distance in chunks the chunk loading thread is loading, at most the target
+    atomic_int viewDistance;
+    /// The most bytes of chunks and meshes to keep resident, or 0 for no limit
+    atomic_size_t memoryBudget;
+    /// The distance in chunks set with world_setLodDistance, or 0 to mesh everything at full detail
+    atomic_int lodDistance;
+    /// The LOD distance the chunks' mesh levels of detail were last checked against, only used by the chunk loading thread
+    int meshLodDistance;
+    /// The bytes of chunk meshes uploaded to the GPU
+    atomic_size_t meshBytes;
+    /// The memory held by the block palettes of this world's chunks
+    blockPaletteStats_t paletteStats;
+    /// The chunk loading passes left before the memory budget is checked again
+    int viewDistanceSettle;
+    /// The load sphere of each chunk loader as of the last pass, only used by the chunk loading thread
+    loadSphere_t loadSpheres[MAX_CHUNK_LOADERS];
+    /// Wakes the chunk loading thread from world_waitForChunkWork
+    struct {
+        pthread_mutex_t lock;
+        pthread_cond_t cond;
+        /// Whether there has been new work since the chunk loading thread last woke
+        bool pending;
+    } wake;
+    /// Set by the chunk loading thread while retired objects wait for the render thread to move on
+    atomic_bool reclaimPending;
+    /// Runs chunk generation and meshing in parallel for the chunk loading thread
+    jobPool_t jobs;
+    /// Scratch arrays for the chunks of a parallel batch, only used by the chunk loading thread
+    struct {
+        /// The cells of chunks queued for generation
+        struct chunkValue_t **values;
+        /// The chunks of the batch
+        chunk_t **chunks;
+        /// The number of chunks queued for generation
+        size_t n;
+        /// The capacity of both arrays
+        size_t capacity;
+    } batch;
+    /// The reusable mesh inputs of a parallel meshing batch, only used by the chunk loading thread
+    struct {
+        /// The heap-allocated tasks, each allocated on its own as an input is large
+        struct meshTask_t **items;
+        /// The number of tasks allocated
+        size_t capacity;
+    } meshTasks;
+    /// The number of meshes handed to the render thread that it hasn't finished with
+    atomic_size_t meshesInFlight;
+    /// Set by the chunk loading thread when it held back meshing because the mesh queue was full
+    atomic_bool meshQueueFull;
+    /// The meshes taken from the mesh queue and waiting to be uploaded, only used by the render thread
+    struct {
+        struct pendingUpload_t *items;
+        size_t n;
+        size_t capacity;
+    } uploads;
+    /// The chunk of the latest block edit, whose meshes are uploaded first, only used by the render thread
+    struct {
+        bool valid;
+        int cx, cy, cz;
+    } lastEdit;
+    /// What the last world_remeshChunks call did, only used by the render thread
+    worldUploadStats_t uploadStats;
+    /// The chunks waiting to be generated, nearest and in view first, only used by the chunk loading thread
+    loadQueue_t loadQueue;
+    /// The number of requests in the load queue, for other threads
+    atomic_size_t pendingChunks;
+    /// The camera frustum set with world_setLoadView, written by the render thread
+    struct {
+        pthread_mutex_t lock;
+        /// The frustum planes
+        double planes[6][4];
+        /// Whether a frustum has been set
+        bool valid;
+        /// Incremented whenever the frustum changes
+        unsigned int version;
+    } view;
+    /// The chunk loading thread's copy of view, as of the last pass
+    struct {
+        double planes[6][4];
+        bool valid;
+        unsigned int version;
+    } loaderView;
+    /// The chunks that left every load sphere and wait to be unloaded, only used by the chunk loading thread
+    struct {
+        retainedChunk_t *items;
+        size_t n;
+        size_t capacity;
+        /// When the next retained chunk outside every retain radius may be unloaded, or 0 if none
+        double deadline;
+    } retained;
+    /// The counters returned by world_getLoadStats, written by the chunk loading thread
+    struct {
+        atomic_size_t generated;
+        atomic_size_t retained;
+        atomic_size_t regenerationsAvoided;
+        atomic_size_t airChunks;
+        atomic_size_t stoneChunks;
+    } loadStats;
+    /// The stage timings of the last pass, only used by the chunk loading thread
+    worldPassTimes_t passTimes;
+    /// When the world was initialised, in seconds on the monotonic clock
+    double startTime;
+    /// The seconds from initialisation until the first chunk in view was meshed, or negative until then
+    _Atomic(double) firstVisibleTime;
+    /// The index used for keeping track of chunk clusters, only used by the chunk loading thread
+    clusterIndex_t clusters;
+    /// The terrain columns of the chunks around the chunk loaders, only used by the chunk loading thread
+    columnCache_t columns;
+    /// The latest snapshot of the fully loaded chunks
+    _Atomic(chunkSnapshot_t *) snapshot;
+    /// Whether a chunk has been fully loaded or freed since the snapshot was built
+    bool snapshotDirty;
+    /// The sequence number of the latest snapshot, only used by the chunk loading thread
+    uint64_t snapshotSequence;
+    /// The snapshot the render thread is reading, set by world_beginRead
+    const chunkSnapshot_t *readSnapshot;
+    /// Defers reclaiming chunks, palette buffers and snapshots until the render thread is past them
+    epoch_t epoch;
     /// The world's highlight Vao
     GLuint highlightVao;
     /// The world's highlight Vbo
@@ -103,9 +354,63 @@ typedef struct world_t {
 
     struct {
         spscRing_t chunkBufferFreeQueue;
+        /// Block edits from the render thread, applied by the chunk loading thread
+        spscRing_t editQueue;
+        /// Single block edits posted back by the chunk loading thread once applied
+        spscRing_t editResultQueue;
+        /// Meshes built by the chunk loading thread, uploaded by the render thread
+        spscRing_t meshQueue;
     } queues;
+
+    /// Recycled allocations, only acquired from and released to by the chunk loading thread
+    struct {
+        /// The pool of chunk_t objects
+        pool_t chunks;
+        /// The pool of cluster cell arrays
+        pool_t clusterCells;
+    } pools;
 } world_t;
 
+/**
+ * @brief Statistics about the memory held by a world
+ */
+typedef struct {
+    /// The chunk pool statistics
+    poolStats_t chunks;
+    /// The cluster cell array pool statistics
+    poolStats_t clusterCells;
+    /// The terrain column pool statistics
+    poolStats_t columns;
+    /// The bytes held by the packed blocks of every chunk, both live and free
+    size_t blockBytes;
+    /// The number of live chunks stored as a single block type, without packed blocks
+    size_t uniformChunks;
+    /// The bytes held by the pools and packed blocks, both live and free, including terrain columns
+    size_t residentBytes;
+    /// The bytes of chunk meshes uploaded to the GPU
+    size_t meshBytes;
+    /// The bytes counted against the memory budget: live chunks, cluster cell arrays,
+    /// packed blocks and meshes
+    size_t budgetedBytes;
+} worldMemoryStats_t;
+
+/**
+ * @brief Counters for how the chunk loading thread has spent its work
+ */
+typedef struct {
+    /// The number of chunks generated
+    size_t generated;
+    /// The number of loaded chunks that no load sphere holds any more
+    size_t retained;
+    /// The number of chunks that re-entered a load sphere while still loaded, each of
+    /// which would otherwise have been generated and meshed again
+    size_t regenerationsAvoided;
+    /// The number of generated chunks that were above the terrain, so had no blocks to generate
+    size_t airChunks;
+    /// The number of generated chunks that were deep enough to be filled with stone outright
+    size_t stoneChunks;
+} worldLoadStats_t;
+
 /**
  * @brief Contains data about what stage of loading the chunk is
  */
@@ -139,10 +444,71 @@ typedef struct chunkValue_t {
         reloadData_e reload;
         size_t nChildren;
         struct chunkValue_t *children[32];
+        /// The number of loaded chunks holding this one in their children
+        size_t nParents;
+        /// The number of chunk loaders whose load sphere contains this chunk
+        int nLoaders;
     } loadData;
 
 } chunkValue_t;
 
+/**
+ * @brief A single block write of a region edit
+ */
+typedef struct {
+    /// The block position
+    int x, y, z;
+    /// The block to write, or BL_AIR to remove the block there
+    block_t block;
+} worldBlockEdit_t;
+
+/**
+ * @brief A run of consecutive blocks along z within a single chunk, as yielded by
+ *        world_spanNext
+ * @note Blocks are read straight out of the chunk's block storage with worldSpan_get
+ */
+typedef struct {
+    /// The world position of the first block of the span
+    int x, y, z;
+    /// The number of blocks in the span
+    int length;
+    /// The chunk holding the span, or NULL if it isn't loaded, in which case every block reads as air
+    const chunk_t *chunk;
+
+    /// The snapshot being walked
+    const chunkSnapshot_t *snapshot;
+    /// The box being walked, with an exclusive max corner
+    ivec3 min, max;
+    /// The chunk coordinates of the current chunk, and of the last chunk
+    ivec3 chunkPos, lastChunk;
+    /// The part of the box within the current chunk, in chunk-local coordinates
+    ivec3 lo, hi;
+    /// The chunk-local x and y of the next span
+    int nextX, nextY;
+    /// Whether every span has been yielded
+    bool done;
+} worldSpan_t;
+
+/**
+ * @brief Gets a block of a span
+ * @param s A pointer to a span
+ * @param i The index of the block within the span, from 0 to length - 1
+ * @return The block type
+ */
+static inline block_t worldSpan_get(const worldSpan_t *s, const int i) {
+    if (!s->chunk) return BL_AIR;
+    return chunk_getBlock(s->chunk, s->x & (CHUNK_SIZE - 1), s->y & (CHUNK_SIZE - 1), (s->z & (CHUNK_SIZE - 1)) + i);
+}
+
+/**
+ * @brief Checks whether a span is known to be all air without reading each block
+ * @param s A pointer to a span
+ * @return Whether the span's chunk is unloaded or entirely air
+ */
+static inline bool worldSpan_isAir(const worldSpan_t *s) {
+    return !s->chunk || (chunk_isUniform(s->chunk) && blockPalette_get(&s->chunk->blocks, 0) == BL_AIR);
+}
+
 /**
  * @brief Initialises a world struct.
  * @param w A pointer to a world
@@ -151,10 +517,131 @@ typedef struct chunkValue_t {
 void world_init(world_t *w, uint64_t seed);
 
 /**
- * @brief Remeshes any chunks that need to be remeshed.
+ * @brief Reads the memory statistics of a world
+ * @param w A pointer to a world
+ * @return The statistics
+ * @note Safe to call from any thread
+ */
+worldMemoryStats_t world_getMemoryStats(const world_t *w);
+
+/**
+ * @brief Reads the chunk loading counters of a world
  * @param w A pointer to a world
+ * @return The counters
+ * @note Safe to call from any thread
  */
-void world_remeshChunks(world_t *w);
+worldLoadStats_t world_getLoadStats(const world_t *w);
+
+/**
+ * @brief Gets how long the stages of the last chunk loading pass took
+ * @param w A pointer to a world
+ * @return The timings
+ * @note Only safe to call from the chunk loading thread, or while it isn't running
+ */
+worldPassTimes_t world_getPassTimes(const world_t *w);
+
+/**
+ * @brief Sets how many released chunks and cluster cell arrays the world keeps for reuse
+ * @param w A pointer to a world
+ * @param chunks The high-water mark of the chunk pool
+ * @param clusterCells The high-water mark of the cluster cell array pool
+ * @note Must be called from the chunk loading thread, or while it isn't running
+ */
+void world_setPoolHighWater(world_t *w, size_t chunks, size_t clusterCells);
+
+/**
+ * @brief Sets how many threads generate and mesh chunks
+ * @param w A pointer to a world
+ * @param nThreads The number of threads, including the chunk loading thread itself.
+ *        A world starts with 1, which does everything on the chunk loading thread.
+ * @note Must be called while the chunk loading thread isn't running
+ */
+void world_setGenerationThreads(world_t *w, int nThreads);
+
+/**
+ * @brief Sets how the terrain noise is sampled
+ * @param w A pointer to a world
+ * @param sampling TERRAIN_EXACT, which a world starts with, or TERRAIN_COARSE
+ * @note Must be called before any chunks are loaded, while the chunk loading thread
+ *       isn't running, so the whole world is generated the same way
+ */
+void world_setTerrainSampling(world_t *w, terrainSampling_e sampling);
+
+/**
+ * @brief Sets the view distance chunks are loaded and drawn to
+ * @param w A pointer to a world
+ * @param distance The view distance in chunks, clamped to MIN_VIEW_DISTANCE and MAX_VIEW_DISTANCE
+ * @note Safe to call from any thread. The chunk loading thread picks it up on its next
+ *       pass, and may load less than this while over the memory budget.
+ */
+void world_setViewDistance(world_t *w, int distance);
+
+/**
+ * @brief Sets the distance beyond which chunks are meshed at lower detail
+ * @param w A pointer to a world
+ * @param distance The distance in chunks from the nearest chunk loader, clamped to
+ *        MAX_VIEW_DISTANCE, or 0 to mesh every chunk at full detail
+ * @note Safe to call from any thread. Chunks beyond this distance are meshed with cells
+ *       2 blocks across, and beyond twice it with cells MAX_MESH_LOD blocks across,
+ *       so far chunks cost a fraction of the vertices and the view distance can be
+ *       raised. Chunks are remeshed as they cross between levels.
+ */
+void world_setLodDistance(world_t *w, int distance);
+
+/**
+ * @brief Gets the view distance the chunk loading thread is currently loading to
+ * @param w A pointer to a world
+ * @return The view distance in chunks
+ * @note Safe to call from any thread
+ */
+int world_getViewDistance(const world_t *w);
+
+/**
+ * @brief Sets the memory budget, which shrinks the view distance while the budgeted
+ *        bytes in world_getMemoryStats exceed it, and lets it grow back once they
+ *        are comfortably under it again
+ * @param w A pointer to a world
+ * @param bytes The budget in bytes, or 0 for no limit
+ * @note Safe to call from any thread
+ */
+void world_setMemoryBudget(world_t *w, size_t bytes);
+
+/**
+ * @brief Starts a read section on the render thread, taking the latest chunk snapshot
+ * @param w A pointer to a world
+ * @note Every render thread call that touches chunks must be inside a read section.
+ *       Read sections should be short, as nothing unloaded in the meantime can be
+ *       reclaimed until they end.
+ */
+void world_beginRead(world_t *w);
+
+/**
+ * @brief Ends a read section on the render thread
+ * @param w A pointer to a world
+ */
+void world_endRead(world_t *w);
+
+/**
+ * @brief Uploads the meshes the chunk loading thread has built, nearest the camera
+ *        first, within the per-frame upload budget
+ * @param w A pointer to a world
+ * @param eye The camera position
+ * @note Called once a frame from the render thread, inside a read section. Meshes of
+ *       the chunks around the latest block edit go first, then the rest by distance,
+ *       until UPLOAD_BUDGET_BYTES have been uploaded or UPLOAD_BUDGET_MS have passed.
+ *       At least one mesh is uploaded each call, and the rest wait for later frames.
+ *       A mesh is only uploaded once the snapshot being read holds its chunk, and
+ *       until then its chunk keeps drawing the previous mesh.
+ */
+void world_remeshChunks(world_t *w, vec3 eye);
+
+/**
+ * @brief Gets what the last world_remeshChunks call uploaded and deferred
+ * @param w A pointer to a world
+ * @return The statistics
+ * @note Called from the render thread
+ */
+worldUploadStats_t world_getUploadStats(const world_t *w);
 
 /**
  * @brief Processes all the concurrent queues of the world
@@ -184,6 +671,7 @@ void world_free(world_t *w);
 * @param cy Target chunk's y coordinate
 * @param cz Target chunk's z coordinate
 * @return A pointer to the chunk. Returns NULL if chunk isn't fully loaded.
+* @note Only used by the chunk loading thread
 */
 chunk_t *world_getFullyLoadedChunk(world_t *w, const int cx, const int cy, const int cz);
 
@@ -204,6 +692,20 @@ bool world_genChunkLoader(world_t *w, unsigned int *id);
  */
 void world_updateChunkLoader(world_t *w, unsigned int id, const float pos[3]);
 
+/**
+ * @brief Updates the position of a specific chunk loader and prefetches chunks along
+ *        the path predicted from its velocity
+ * @param w A pointer to a world
+ * @param id The id of the chunk loader
+ * @param pos The new position
+ * @param velocity The velocity in blocks per second
+ * @note The path runs PREFETCH_SECONDS ahead, up to PREFETCH_MAX_CHUNKS chunks, and
+ *       the chunks within PREFETCH_RADIUS of it are generated after the load sphere
+ *       at the same distance. When the path changes, prefetched chunks that are no
+ *       longer on it are cancelled or unloaded. Silently fails if the id is not valid.
+ */
+void world_updateChunkLoaderPrefetch(world_t *w, unsigned int id, const float pos[3], const float velocity[3]);
+
 /**
  * @brief Deletes a chunk loader from an id.
  * @param w A pointer to a world
@@ -212,11 +714,72 @@ void world_updateChunkLoader(world_t *w, unsigned int id, const float pos[3]);
 void world_delChunkLoader(world_t *w, unsigned int id);
 
 /**
- * @brief Considers all chunk loaders and loads the correct chunks
+ * @brief Applies queued block edits, loads and unloads the chunks entering and
+ *        leaving each chunk loader's load sphere since the last pass, then lights
+ *        and meshes them and publishes a new snapshot if anything changed
  * @param w A pointer to a world
+ * @note Only one thread may do chunk loading. Chunks entering a load sphere are
+ *       queued and each pass only generates the next LOAD_BATCH_PER_THREAD per
+ *       generation thread, nearest to a chunk loader and inside the camera frustum
+ *       first, so the rest are left for later passes.
  */
 void world_doChunkLoading(world_t *w);
 
+/**
+ * @brief Runs chunk loading passes until every chunk the chunk loaders need is loaded
+ * @param w A pointer to a world
+ * @note For loading everything up front, before the chunk loading thread starts
+ */
+void world_loadPendingChunks(world_t *w);
+
+/**
+ * @brief Gets the number of chunks waiting to be generated
+ * @param w A pointer to a world
+ * @return The number of chunks
+ * @note Safe to call from any thread. It may count chunks that have since been
+ *       unloaded until the chunk loading thread drops them.
+ */
+size_t world_getPendingChunks(const world_t *w);
+
+/**
+ * @brief Sets the camera frustum that chunk generation is prioritised by, so that
+ *        chunks in view are generated before those behind the camera
+ * @param w A pointer to a world
+ * @param cam A pointer to the camera
+ * @param projection The projection matrix
+ * @note Called by the render thread every frame
+ */
+void world_setLoadView(world_t *w, camera_t *cam, mat4 projection);
+
+/**
+ * @brief Gets how long the first chunk in view took to be meshed after the world
+ *        was initialised, the time to first visible chunk
+ * @param w A pointer to a world
+ * @return The time in seconds, or a negative value if no chunk in view has been
+ *         meshed yet
+ * @note Safe to call from any thread
+ */
+double world_getFirstVisibleTime(const world_t *w);
+
+/**
+ * @brief Blocks the chunk loading thread until there is work for world_doChunkLoading
+ * @param w A pointer to a world
+ * @note Work is a chunk loader crossing into another chunk, being added or removed,
+ *       a queued edit, a view distance or memory budget change, an uploaded mesh,
+ *       chunks left waiting to be generated, or unloaded chunks waiting to be
+ *       reclaimed. While the memory budget is settling it only sleeps for
+ *       VIEW_DISTANCE_SETTLE_MS, and while a retained chunk waits out its grace
+ *       period it only sleeps until that ends.
+ */
+void world_waitForChunkWork(world_t *w);
+
+/**
+ * @brief Wakes the chunk loading thread from world_waitForChunkWork
+ * @param w A pointer to a world
+ * @note Safe to call from any thread
+ */
+void world_wakeChunkLoading(world_t *w);
+
 
 /**
  * @brief Gets a block (if possible) at by the block position.
@@ -247,13 +810,22 @@ bool world_getBlock(world_t *w, const vec3 position, blockData_t *bd);
 void world_getAdjacentBlocks(world_t *w, vec3 position, blockData_t *buf);
 
 /**
- * @brief gets all blocks within a cuboid defined by two opposite corners
- * @param w a pointer to the world
- * @param minPoint bottom left corner of the cuboid
- * @param maxPoint top right corner of the cuboid
- * @param buf the array where the blocks are stored
+ * @brief Starts walking the blocks of a cuboid chunk by chunk
+ * @param w A pointer to a world
+ * @param s A pointer to the span to initialise
+ * @param minPoint The lowest corner of the cuboid, inclusive
+ * @param maxPoint The highest corner of the cuboid, exclusive
+ * @note Must be used from the render thread, within the read section the walk ends in
  */
-void world_getBlocksInRange(world_t *w, vec3 minPoint, const vec3 maxPoint, blockData_t *buf);
+void world_spanBegin(const world_t *w, worldSpan_t *s, const ivec3 minPoint, const ivec3 maxPoint);
+
+/**
+ * @brief Moves a span on to the next run of blocks
+ * @param s A pointer to a span started with world_spanBegin
+ * @return Whether there was another run. Every block of the cuboid is covered once,
+ *         one chunk at a time, with runs in x then y order within each chunk.
+ */
+bool world_spanNext(worldSpan_t *s);
 
 /**
  * @brief Performs raycasting from a point at a specific angle
@@ -272,7 +844,9 @@ raycast_t world_raycast(world_t *w, vec3 startPosition, vec3 viewDirection, floa
  * @param x Block x
  * @param y Block y
  * @param z Block z
- * @return Whether the operation was successful
+ * @return Whether the removal was queued
+ * @note The removal is applied by the chunk loading thread, and the item is spawned
+ *       and the sound played by world_processAllEntities once it has been
  */
 bool world_removeBlock(world_t *w, int x, int y, int z);
 
@@ -283,14 +857,41 @@ bool world_removeBlock(world_t *w, int x, int y, int z);
  * @param y Block y
  * @param z Block z
  * @param block The type of block to try and place
- * @return Whether the operation was successful
+ * @return Whether the placement was queued
+ * @note The placement is applied by the chunk loading thread, which drops it if the
+ *       position is no longer air, and the sound is played by world_processAllEntities
+ *       once it has been
  */
 bool world_placeBlock(world_t *w, int x, int y, int z, block_t block);
 
+/**
+ * @brief Writes many blocks at once, replacing whatever is there
+ * @param w A pointer to the world
+ * @param edits An array of block writes, applied in order
+ * @param n The number of block writes
+ * @return Whether the edit could be queued
+ * @note The writes are queued as one batch and applied by the chunk loading thread,
+ *       which seeds the lighting for every write but then propagates light and
+ *       remeshes each affected chunk once for the whole batch. Writes to chunks that
+ *       aren't fully loaded by then are dropped, and no items or sounds are produced.
+ */
+bool world_editRegion(world_t *w, const worldBlockEdit_t *edits, size_t n);
+
+/**
+ * @brief Fills a cuboid with a single block, as a region edit
+ * @param w A pointer to the world
+ * @param minPoint The lowest corner of the cuboid, inclusive
+ * @param maxPoint The highest corner of the cuboid, exclusive
+ * @param block The block to fill with, or BL_AIR to clear the cuboid
+ * @return Whether the edit could be queued
+ */
+bool world_fillRegion(world_t *w, const ivec3 minPoint, const ivec3 maxPoint, block_t block);
+
 /**
 * @brief Saves the currently loaded world
 * @param w A pointer to a world
 * @param dir The name of the directory to save the file in
+* @note Must be called from the chunk loading thread, or while it isn't running
 */
 bool world_save(const world_t *w, const char *dir);
 
@@ -312,6 +913,8 @@ void world_drawHighlight(const world_t *w, int modelLocation);
  * @brief Updates all entities and their positions/velcities
  * @param w A pointer to a world
  * @param dt the time since the function was last run
+ * @note First spawns the items and plays the sounds of block edits the chunk
+ *       loading thread has applied since the last call
  */
 void world_processAllEntities(world_t *w, double dt);
 